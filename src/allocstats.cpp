@@ -0,0 +1,46 @@
+/**
+ * @file allocstats.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Replacement of the global operator new/delete counting heap allocations
+ */
+#include "allocstats.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<std::uint64_t> allocationCount{0};
+static std::atomic<std::uint64_t> deallocationCount{0};
+static std::atomic<std::uint64_t> allocatedBytes{0};
+
+/**
+ * @brief Read the current values of the counters
+ */
+AllocStats AllocStats::now() {
+    return AllocStats{allocationCount.load(std::memory_order_relaxed),
+                      deallocationCount.load(std::memory_order_relaxed),
+                      allocatedBytes.load(std::memory_order_relaxed)};
+}
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    while (true) {
+        void* pointer = std::malloc(size);
+        if (pointer) return pointer;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* pointer) noexcept {
+    if (!pointer) return;
+    deallocationCount.fetch_add(1, std::memory_order_relaxed);
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
@@ -0,0 +1,23 @@
+/**
+ * @file allocstats.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Counters of heap allocations done through the global operator new
+ */
+#ifndef ALLOCSTATS_H
+#define ALLOCSTATS_H
+
+#include <cstdint>
+
+/**
+ * @brief Snapshot of the heap allocation counters
+ */
+struct AllocStats {
+    std::uint64_t allocations;
+    std::uint64_t deallocations;
+    std::uint64_t bytes;
+
+    static AllocStats now();
+};
+
+#endif // ALLOCSTATS_H
@@ -0,0 +1,118 @@
+/**
+ * @file archetype.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Dense component table storing all entities of one archetype
+ */
+#ifndef ARCHETYPE_H
+#define ARCHETYPE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "arena.h"
+
+/**
+ * @class Archetype
+ * @brief Table with one dense column per component
+ * @details row i of every column belongs to the same entity, systems iterate
+ * the columns they need directly without any virtual dispatch
+ */
+template <typename... Components>
+class Archetype {
+public:
+    static constexpr std::size_t rowBytes = (sizeof(Components) + ...);  // bytes of one entity
+
+    std::size_t size() const {
+        return std::get<0>(columns).size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Append a new entity
+     *
+     * @return row of the new entity
+     */
+    std::size_t add(const Components&... values) {
+        (std::get<std::vector<Components>>(columns).push_back(values), ...);
+        return size() - 1;
+    }
+
+    /**
+     * @brief Remove the entity by moving the last row into its place
+     *
+     * @param row row to remove
+     */
+    void remove(std::size_t row) {
+        std::size_t last = size() - 1;
+        (removeFrom(std::get<std::vector<Components>>(columns), row, last), ...);
+    }
+
+    void clear() {
+        (std::get<std::vector<Components>>(columns).clear(), ...);
+    }
+
+    /**
+     * @brief Reorder the rows, new row i is the old row order[i]
+     * @details order must be a permutation of all rows, columns are copied
+     * through scratch storage of the arena
+     */
+    void permute(const std::uint32_t* order, FrameArena& scratch) {
+        (permuteColumn(std::get<std::vector<Components>>(columns), order, scratch), ...);
+    }
+
+    /**
+     * @brief Bytes reserved by all columns, including unused capacity
+     */
+    std::size_t allocatedBytes() const {
+        return ((std::get<std::vector<Components>>(columns).capacity() * sizeof(Components)) + ...);
+    }
+
+    template <typename C>
+    std::vector<C>& column() {
+        return std::get<std::vector<C>>(columns);
+    }
+
+    template <typename C>
+    const std::vector<C>& column() const {
+        return std::get<std::vector<C>>(columns);
+    }
+
+    template <typename C>
+    C& get(std::size_t row) {
+        return column<C>()[row];
+    }
+
+    template <typename C>
+    const C& get(std::size_t row) const {
+        return column<C>()[row];
+    }
+
+private:
+    std::tuple<std::vector<Components>...> columns;
+
+    template <typename C>
+    static void permuteColumn(std::vector<C>& column, const std::uint32_t* order, FrameArena& scratch) {
+        C* copy = scratch.allocate<C>(column.size());
+        for (std::size_t i = 0; i < column.size(); ++i) {
+            copy[i] = column[order[i]];
+        }
+        std::copy(copy, copy + column.size(), column.begin());
+    }
+
+    template <typename C>
+    static void removeFrom(std::vector<C>& column, std::size_t row, std::size_t last) {
+        if (row != last) {
+            column[row] = std::move(column[last]);
+        }
+        column.pop_back();
+    }
+};
+
+#endif // ARCHETYPE_H
@@ -0,0 +1,160 @@
+/**
+ * @file arena.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Per-tick bump arena and fixed-size block pool
+ */
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+/**
+ * @class FrameArena
+ * @brief Bump allocator for temporary data of one tick
+ * @details everything allocated during the tick is released at once by reset().
+ * When a tick needs more than the capacity, the rest is taken from the heap and
+ * the arena grows to the high water mark on the next reset, so steady-state
+ * ticks never touch the heap
+ */
+class FrameArena {
+public:
+    explicit FrameArena(std::size_t capacity = 64 * 1024) {
+        buffer.resize(capacity);
+    }
+
+    ~FrameArena() {
+        releaseOverflow();
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * @brief Allocate uninitialized storage for n objects of trivial type T
+     */
+    template <typename T>
+    T* allocate(std::size_t n) {
+        std::size_t bytes = n * sizeof(T);
+        std::size_t start = (offset + alignof(T) - 1) & ~(alignof(T) - 1);
+        if (start + bytes <= buffer.size()) {
+            offset = start + bytes;
+            highWater = offset > highWater ? offset : highWater;
+            return reinterpret_cast<T*>(buffer.data() + start);
+        }
+        // does not fit, take it from the heap for this tick
+        overflowBytes += bytes;
+        ++overflowCount;
+        void* block = ::operator new(bytes);
+        overflow.push_back(block);
+        return static_cast<T*>(block);
+    }
+
+    /**
+     * @brief Release everything allocated since the last reset
+     */
+    void reset() {
+        if (!overflow.empty()) {
+            releaseOverflow();
+            std::size_t needed = highWater + overflowBytes;
+            buffer.resize(needed + needed / 2);
+        }
+        offset = 0;
+        overflowBytes = 0;
+    }
+
+    std::size_t capacity() const { return buffer.size(); }
+    std::size_t used() const { return offset; }
+    std::size_t peak() const { return highWater; }
+    std::uint64_t overflows() const { return overflowCount; }
+
+private:
+    std::vector<unsigned char> buffer;
+    std::vector<void*> overflow;
+    std::size_t offset = 0;
+    std::size_t highWater = 0;
+    std::size_t overflowBytes = 0;
+    std::uint64_t overflowCount = 0;
+
+    void releaseOverflow() {
+        for (void* block : overflow) {
+            ::operator delete(block);
+        }
+        overflow.clear();
+    }
+};
+
+/**
+ * @class BlockPool
+ * @brief Pool of fixed-size blocks for objects created and deleted one by one
+ * @details blocks are carved from chunks and recycled through a free list,
+ * memory is only requested from the heap when a new chunk is needed
+ */
+class BlockPool {
+public:
+    BlockPool(std::size_t blockSize, std::size_t blocksPerChunk = 256)
+        : blockSize(roundUp(blockSize)), blocksPerChunk(blocksPerChunk) {}
+
+    ~BlockPool() {
+        for (unsigned char* chunk : chunks) {
+            ::operator delete(chunk);
+        }
+    }
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    void* allocate() {
+        if (!freeList) {
+            grow();
+        }
+        FreeBlock* block = freeList;
+        freeList = block->next;
+        ++liveBlocks;
+        return block;
+    }
+
+    void release(void* pointer) {
+        FreeBlock* block = static_cast<FreeBlock*>(pointer);
+        block->next = freeList;
+        freeList = block;
+        --liveBlocks;
+    }
+
+    std::size_t size() const { return blockSize; }
+    std::size_t live() const { return liveBlocks; }
+    std::size_t chunkCount() const { return chunks.size(); }
+    std::size_t reservedBytes() const { return chunks.size() * blocksPerChunk * blockSize; }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    std::size_t blockSize;
+    std::size_t blocksPerChunk;
+    std::vector<unsigned char*> chunks;
+    FreeBlock* freeList = nullptr;
+    std::size_t liveBlocks = 0;
+
+    static std::size_t roundUp(std::size_t size) {
+        std::size_t align = alignof(std::max_align_t);
+        size = size < sizeof(FreeBlock) ? sizeof(FreeBlock) : size;
+        return (size + align - 1) & ~(align - 1);
+    }
+
+    void grow() {
+        unsigned char* chunk = static_cast<unsigned char*>(::operator new(blockSize * blocksPerChunk));
+        chunks.push_back(chunk);
+        for (std::size_t i = blocksPerChunk; i-- > 0;) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * blockSize);
+            block->next = freeList;
+            freeList = block;
+        }
+    }
+};
+
+#endif // ARENA_H
@@ -0,0 +1,229 @@
+/**
+ * @file behaviors.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Compile time policies robot behaviors are composed of
+ * @details a behavior is a combination of a motion model, a sensor model and a
+ * reaction policy, World::runBehavior() instantiates one loop per combination,
+ * so every policy call is inlined into it
+ */
+#ifndef BEHAVIORS_H
+#define BEHAVIORS_H
+
+#include <cstddef>
+#include "world.h"
+
+/**
+ * @brief Motion model: move 10% of the speed towards the orientation every tick
+ */
+struct InterpolatedMotion {
+    /**
+     * @brief Distance moved in one tick
+     */
+    static double stepLength(const ParamBlock& params) {
+        return 0.1 * params.speed;
+    }
+
+    /**
+     * @brief Robot standing still, it may sleep while its field of vision stays free
+     */
+    template <typename Table>
+    static bool isParked(const World& world, const Table& table, std::size_t row) {
+        return world.params(table.template get<Params>(row).block).speed == 0;
+    }
+
+    template <typename Table>
+    static bool move(const World& world, Table& table, std::size_t row) {
+        Position& position = table.template get<Position>(row);
+        UnitVector direction = unitVector(table.template get<Heading>(row).orientation);
+        int speed = world.params(table.template get<Params>(row).block).speed;
+
+        double targetX = position.x + speed * double(direction.x);
+        double targetY = position.y + speed * double(direction.y);
+        position.x = float(position.x + 0.1 * (targetX - position.x));
+        position.y = float(position.y + 0.1 * (targetY - position.y));
+        return true;
+    }
+};
+
+/**
+ * @brief Move the position by speed / divisor pixels towards the orientation in fixed point
+ */
+inline void fixedAdvance(Position& position, int orientation, std::int64_t speed, std::int64_t divisor) {
+    std::int64_t scale = divisor * trigOne;
+    position.x = float(fromFixed(toFixed(position.x) + divRound(speed * fixedOne * fixedCos(orientation), scale)));
+    position.y = float(fromFixed(toFixed(position.y) + divRound(speed * fixedOne * fixedSin(orientation), scale)));
+}
+
+/**
+ * @brief Motion model: InterpolatedMotion in fixed point, the step is rounded to 1/16 px
+ */
+struct FixedInterpolatedMotion {
+    static double stepLength(const ParamBlock& params) {
+        return 0.1 * params.speed;
+    }
+
+    template <typename Table>
+    static bool isParked(const World& world, const Table& table, std::size_t row) {
+        return InterpolatedMotion::isParked(world, table, row);
+    }
+
+    template <typename Table>
+    static bool move(const World& world, Table& table, std::size_t row) {
+        fixedAdvance(table.template get<Position>(row), table.template get<Heading>(row).orientation,
+                     world.params(table.template get<Params>(row).block).speed, 10);
+        return true;
+    }
+};
+
+/**
+ * @brief Motion model: rotate and move as commanded by the operator
+ * @details Drive is the motion model moving the robot forward
+ * @return false when the robot is not moving, the sensor is then skipped
+ */
+template <typename Drive>
+struct CommandedMotion {
+    static double stepLength(const ParamBlock& params) {
+        return Drive::stepLength(params);
+    }
+
+    /**
+     * @brief Stopped and not rotating, the robot sleeps until the next command
+     */
+    template <typename Table>
+    static bool isParked(const World&, const Table& table, std::size_t row) {
+        const RemoteControl& control = table.template get<RemoteControl>(row);
+        return !control.isMoving && control.rotationDirection == NoRotation;
+    }
+
+    template <typename Table>
+    static bool move(const World& world, Table& table, std::size_t row) {
+        RemoteControl& control = table.template get<RemoteControl>(row);
+        std::uint16_t& orientation = table.template get<Heading>(row).orientation;
+        if (control.rotationDirection == RotateRight) {
+            orientation = normalizeDegrees(orientation + 1);
+        } else if (control.rotationDirection == RotateLeft) {
+            orientation = normalizeDegrees(orientation - 1);
+        }
+        if (!control.isMoving) {
+            return false;
+        }
+        return Drive::move(world, table, row);
+    }
+};
+
+/**
+ * @brief Sensor model: trapezoid field of vision in front of the robot
+ */
+struct FieldOfViewSensor {
+    template <typename Table>
+    static bool sense(const World& world, const Table& table, std::size_t row) {
+        const Position& position = table.template get<Position>(row);
+        Vec2 view[4];
+        rotateQuad(world.params(table.template get<Params>(row).block).localView,
+                   unitVector(table.template get<Heading>(row).orientation), view);
+        for (Vec2& corner : view) {
+            corner.x += position.x;
+            corner.y += position.y;
+        }
+        return world.isBlocked(table.template get<Identity>(row).handle, view);
+    }
+
+    /**
+     * @brief Check the area the field of vision sweeps while the robot drives length px straight ahead
+     *
+     * @param margin sideways growth of the area covering rounding of the positions
+     * @param ticks ticks the area has to stay free, the other robots grow by their travel
+     */
+    template <typename Table>
+    static bool senseAhead(const World& world, const Table& table, std::size_t row,
+                           double length, double margin, int ticks) {
+        const Position& position = table.template get<Position>(row);
+        Vec2 swept[4];
+        Vec2 view[4];
+        sweptFieldOfView(world.params(table.template get<Params>(row).block).localView, length, margin, swept);
+        rotateQuad(swept, unitVector(table.template get<Heading>(row).orientation), view);
+        for (Vec2& corner : view) {
+            corner.x += position.x;
+            corner.y += position.y;
+        }
+        return world.isBlocked(table.template get<Identity>(row).handle, view, ticks);
+    }
+};
+
+/**
+ * @brief Sensor model: FieldOfViewSensor in fixed point with an integer separating axis test
+ */
+struct FixedFieldOfViewSensor {
+    template <typename Table>
+    static bool sense(const World& world, const Table& table, std::size_t row) {
+        const Position& position = table.template get<Position>(row);
+        const ParamBlock& params = world.params(table.template get<Params>(row).block);
+        int orientation = table.template get<Heading>(row).orientation;
+        FixedVec view[4];
+        for (int i = 0; i < 4; ++i) {
+            FixedVec corner = fixedRotate(params.fixedView[i], orientation);
+            view[i] = FixedVec{toFixed(position.x) + corner.x, toFixed(position.y) + corner.y};
+        }
+        return world.isBlocked(table.template get<Identity>(row).handle, view);
+    }
+
+    /**
+     * @brief FieldOfViewSensor::senseAhead() in fixed point units
+     */
+    template <typename Table>
+    static bool senseAhead(const World& world, const Table& table, std::size_t row,
+                           double length, double margin, int ticks) {
+        const Position& position = table.template get<Position>(row);
+        int orientation = table.template get<Heading>(row).orientation;
+        Vec2 swept[4];
+        sweptFieldOfView(world.params(table.template get<Params>(row).block).localView, length, margin, swept);
+        FixedVec view[4];
+        for (int i = 0; i < 4; ++i) {
+            FixedVec corner = fixedRotate(FixedVec{toFixed(swept[i].x), toFixed(swept[i].y)}, orientation);
+            view[i] = FixedVec{toFixed(position.x) + corner.x, toFixed(position.y) + corner.y};
+        }
+        return world.isBlocked(table.template get<Identity>(row).handle, view, ticks);
+    }
+};
+
+/**
+ * @brief Reaction policy: turn by the avoidance angle
+ */
+struct TurnByAvoidanceAngle {
+    template <typename Table>
+    static void react(const World& world, Table& table, std::size_t row) {
+        std::uint16_t& orientation = table.template get<Heading>(row).orientation;
+        float avoidanceAngle = world.params(table.template get<Params>(row).block).avoidanceAngle;
+        orientation = normalizeDegrees(static_cast<int>(orientation + avoidanceAngle));
+    }
+};
+
+/**
+ * @brief Reaction policy: stop and wait for the operator
+ */
+struct StopOnContact {
+    template <typename Table>
+    static void react(const World&, Table& table, std::size_t row) {
+        table.template get<RemoteControl>(row) = RemoteControl{};
+    }
+};
+
+/**
+ * @brief Behavior composed of the given policies
+ */
+template <typename MotionModel, typename SensorModel, typename ReactionPolicy>
+struct Behavior {
+    using Move = MotionModel;
+    using Sense = SensorModel;
+    using React = ReactionPolicy;
+};
+
+using AutonomousBehavior = Behavior<InterpolatedMotion, FieldOfViewSensor, TurnByAvoidanceAngle>;
+using RemoteBehavior = Behavior<CommandedMotion<InterpolatedMotion>, FieldOfViewSensor, StopOnContact>;
+
+// fixed point engine mode, see World::setFixedPoint()
+using FixedAutonomousBehavior = Behavior<FixedInterpolatedMotion, FixedFieldOfViewSensor, TurnByAvoidanceAngle>;
+using FixedRemoteBehavior = Behavior<CommandedMotion<FixedInterpolatedMotion>, FixedFieldOfViewSensor, StopOnContact>;
+
+#endif // BEHAVIORS_H
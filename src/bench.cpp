@@ -0,0 +1,432 @@
+/**
+ * @file bench.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Headless benchmark of the simulation engine
+ * @details usage: simulation --bench [--ticks N] [--warmup N] [--no-sort] [--phases] [--fixed]
+ * [--sense-interval N] [--kinetic] [--far-interval N] [--generate OBSTACLES ROBOTS] [scene.txt...], simulation --bench-trig [--headings N] [--rounds N]
+ */
+#include "bench.h"
+#include "allocstats.h"
+#include "perfcounters.h"
+#include "scene.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Options of the benchmark run
+ */
+struct BenchOptions {
+    long ticks = 10000;
+    long warmup = 100;  // ticks before measuring, lets the frame arena reach its steady size
+    long generatedObstacles = 0;
+    long generatedRobots = 0;  // a synthetic world is benchmarked when any of them is set
+    bool spatialSorting = true;
+    bool phases = false;  // time every phase of the tick separately
+    bool fixedPoint = false;
+    long senseInterval = 0;  // 0 keeps the interval of the scene
+    bool kinetic = false;
+    long farInterval = 0;  // 0 keeps the level of detail of the scene
+    std::vector<std::string> scenes;
+};
+
+/**
+ * @brief Time and counters spent in the phases of the ticks, filled by the phase hook
+ */
+struct PhaseProfile {
+    const PerfCounters* counters;
+    std::chrono::steady_clock::time_point started;
+    PerfSample startSample;
+    double seconds[static_cast<int>(Phase::Count)] = {};
+    PerfSample samples[static_cast<int>(Phase::Count)];
+};
+
+static const char* phaseNames[] = {"obstacle grid", "sort", "bin", "autonomous", "remote", "sources", "sinks"};
+
+/**
+ * @brief Phase hook of the world accumulating the phase profile
+ */
+static void recordPhase(void* context, Phase phase, bool begin) {
+    PhaseProfile& profile = *static_cast<PhaseProfile*>(context);
+    if (begin) {
+        profile.startSample = profile.counters->read();
+        profile.started = std::chrono::steady_clock::now();
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    int index = static_cast<int>(phase);
+    profile.samples[index] += profile.counters->read() - profile.startSample;
+    profile.seconds[index] += std::chrono::duration<double>(now - profile.started).count();
+}
+
+/**
+ * @brief Print counter values divided by the number of robot ticks
+ */
+static void printCounters(const PerfCounters& counters, const PerfSample& sample, double robotTicks) {
+    for (int i = 0; i < perfEventCount; ++i) {
+        PerfEvent event = static_cast<PerfEvent>(i);
+        if (counters.available(event)) {
+            std::printf("  %s %.1f", PerfCounters::name(event), sample.values[i] / robotTicks);
+        } else {
+            std::printf("  %s n/a", PerfCounters::name(event));
+        }
+        if (event == Instructions && counters.available(Cycles) && counters.available(Instructions)
+            && sample.values[Cycles] > 0) {
+            std::printf(" (IPC %.2f)", double(sample.values[Instructions]) / sample.values[Cycles]);
+        }
+    }
+    std::printf("\n");
+}
+
+/**
+ * @brief Parse command line arguments following --bench
+ *
+ * @return false on invalid arguments
+ */
+static bool parseOptions(int argc, char *argv[], BenchOptions& options) {
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--sense-interval" && i + 1 < argc) {
+            options.senseInterval = std::strtol(argv[++i], nullptr, 10);
+            if (options.senseInterval <= 0) return false;
+        } else if ((arg == "--ticks" || arg == "--warmup") && i + 1 < argc) {
+            long value = std::strtol(argv[++i], nullptr, 10);
+            if (value < 0) return false;
+            (arg == "--ticks" ? options.ticks : options.warmup) = value;
+        } else if (arg == "--no-sort") {
+            options.spatialSorting = false;
+        } else if (arg == "--phases") {
+            options.phases = true;
+        } else if (arg == "--fixed") {
+            options.fixedPoint = true;
+        } else if (arg == "--kinetic") {
+            options.kinetic = true;
+        } else if (arg == "--far-interval" && i + 1 < argc) {
+            options.farInterval = std::strtol(argv[++i], nullptr, 10);
+            if (options.farInterval <= 0) return false;
+        } else if (arg == "--generate" && i + 2 < argc) {
+            options.generatedObstacles = std::strtol(argv[++i], nullptr, 10);
+            options.generatedRobots = std::strtol(argv[++i], nullptr, 10);
+            if (options.generatedObstacles < 0 || options.generatedRobots < 0) return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            options.scenes.push_back(arg);
+        }
+    }
+    return !options.scenes.empty() || options.generatedObstacles > 0 || options.generatedRobots > 0;
+}
+
+/**
+ * @brief Print the memory used by the world
+ */
+static void printFootprint(const World& world) {
+    MemoryFootprint footprint = world.footprint();
+    std::size_t robots = world.autonomous.size() + world.remote.size();
+    std::size_t entities = robots + world.obstacles.size();
+    std::printf("  bytes/entity: autonomous %zu  remote %zu  obstacle %zu  (row + slot)\n",
+                footprint.autonomousRow, footprint.remoteRow, footprint.obstacleRow);
+    std::printf("  memory: robots %zu  obstacles %zu  slots %zu  grid %zu  params %zu (%zu blocks)  arena %zu\n",
+                footprint.robotTables, footprint.obstacles, footprint.slotMap, footprint.obstacleGrid,
+                footprint.paramBlocks, world.paramBlockCount(), footprint.frameArena);
+    std::printf("  memory total: %.2f MiB (%.1f bytes/entity)\n", footprint.total() / 1048576.0,
+                entities > 0 ? double(footprint.total()) / entities : 0.0);
+}
+
+/**
+ * @brief Print how the cost of a tick varies between the ticks
+ */
+static void printTickSpread(const std::vector<double>& tickSeconds) {
+    if (tickSeconds.empty()) return;
+    double minimum = tickSeconds[0];
+    double maximum = tickSeconds[0];
+    double sum = 0;
+    for (double seconds : tickSeconds) {
+        minimum = std::min(minimum, seconds);
+        maximum = std::max(maximum, seconds);
+        sum += seconds;
+    }
+    double mean = sum / tickSeconds.size();
+    double squares = 0;
+    for (double seconds : tickSeconds) {
+        squares += (seconds - mean) * (seconds - mean);
+    }
+    double deviation = std::sqrt(squares / tickSeconds.size());
+    std::printf("  us/tick: min %.3f  max %.3f  stddev %.3f (%.1f%% of mean)\n", minimum * 1e6, maximum * 1e6,
+                deviation * 1e6, mean > 0 ? 100 * deviation / mean : 0.0);
+}
+
+/**
+ * @brief Run the world and print its report
+ */
+static void benchWorld(const std::string& name, World& world, const BenchOptions& options,
+                       const PerfCounters& counters) {
+    world.setSpatialSorting(options.spatialSorting);
+    if (options.fixedPoint) {
+        world.setFixedPoint(true);
+    }
+    if (options.senseInterval > 0) {
+        world.setSenseInterval(RobotKind::Autonomous, static_cast<int>(options.senseInterval));
+        world.setSenseInterval(RobotKind::Remote, static_cast<int>(options.senseInterval));
+    }
+    if (options.kinetic) {
+        world.setKineticScheduling(true);
+    }
+    if (options.farInterval > 0) {
+        // as if the window showed the default 1500x600 area in the top left corner
+        world.setFarSenseInterval(static_cast<int>(options.farInterval));
+        world.setFocus(Box{0, 0, 1500, 600});
+    }
+    for (long tick = 0; tick < options.warmup; ++tick) {
+        world.step();
+    }
+    std::size_t robots = world.autonomous.size() + world.remote.size();
+    double robotTicks = 0;  // sources and sinks change the count, the per robot figures use the sum over the ticks
+
+    std::uint64_t spawnedBefore = world.spawnCount();
+    std::uint64_t despawnedBefore = world.despawnCount();
+    std::uint64_t sortsBefore = world.sortCount();
+    std::uint64_t checksBefore = world.sensorCheckCount();
+    PhaseProfile profile{};
+    profile.counters = &counters;
+    if (options.phases) {
+        world.setPhaseHook(recordPhase, &profile);
+    }
+    std::vector<double> tickSeconds(static_cast<std::size_t>(options.ticks));
+    AllocStats before = AllocStats::now();
+    PerfSample countersBefore = counters.read();
+    auto start = std::chrono::steady_clock::now();
+    auto tickStart = start;
+    for (long tick = 0; tick < options.ticks; ++tick) {
+        robotTicks += world.autonomous.size() + world.remote.size();
+        world.step();
+        auto tickEnd = std::chrono::steady_clock::now();
+        tickSeconds[tick] = std::chrono::duration<double>(tickEnd - tickStart).count();
+        tickStart = tickEnd;
+    }
+    auto end = tickStart;
+    PerfSample counted = counters.read() - countersBefore;
+    AllocStats after = AllocStats::now();
+    world.setPhaseHook(nullptr, nullptr);
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double ticks = static_cast<double>(options.ticks);
+    std::uint64_t allocations = after.allocations - before.allocations;
+    std::uint64_t spawned = world.spawnCount() - spawnedBefore;
+    std::uint64_t despawned = world.despawnCount() - despawnedBefore;
+
+    std::printf("scene: %s\n", name.c_str());
+    std::printf("  robots: %zu after warmup, %.1f per measured tick  obstacles: %zu\n", robots,
+                ticks > 0 ? robotTicks / ticks : 0.0, world.obstacles.size());
+    std::printf("  ticks: %ld  time: %.3f s  ticks/sec: %.1f  us/tick: %.3f\n",
+                options.ticks, seconds, seconds > 0 ? ticks / seconds : 0.0,
+                ticks > 0 ? seconds * 1e6 / ticks : 0.0);
+    printTickSpread(tickSeconds);
+    if (robotTicks > 0) {
+        std::printf("  ns/robot/tick: %.1f\n", seconds * 1e9 / robotTicks);
+        if (counters.available()) {
+            std::printf("  per robot per tick:");
+            printCounters(counters, counted, robotTicks);
+        }
+    }
+    if (options.phases && robotTicks > 0) {
+        std::printf("  phases (per robot per tick, the hook adds its own overhead):\n");
+        for (int i = 0; i < static_cast<int>(Phase::Count); ++i) {
+            std::printf("    %-13s ns %.1f", phaseNames[i], profile.seconds[i] * 1e9 / robotTicks);
+            if (counters.available()) {
+                printCounters(counters, profile.samples[i], robotTicks);
+            } else {
+                std::printf("\n");
+            }
+        }
+    }
+    if (!world.sources.empty() || !world.sinks.empty()) {
+        std::printf("  spawned: %llu (%.1f/s)  despawned: %llu (%.1f/s)  robots at end: %zu\n",
+                    static_cast<unsigned long long>(spawned), seconds > 0 ? spawned / seconds : 0.0,
+                    static_cast<unsigned long long>(despawned), seconds > 0 ? despawned / seconds : 0.0,
+                    world.autonomous.size() + world.remote.size());
+    }
+    std::printf("  sense interval: autonomous %d  remote %d%s  far %d  sensor checks/robot/tick: %.3f\n",
+                world.senseInterval(RobotKind::Autonomous), world.senseInterval(RobotKind::Remote),
+                world.kineticScheduling() ? " (kinetic)" : "", world.farSenseInterval(),
+                robotTicks > 0 ? (world.sensorCheckCount() - checksBefore) / robotTicks : 0.0);
+    std::printf("  awake robots at end: %zu of %zu  active chunks: %zu of %zu\n", world.awakeCount(),
+                world.autonomous.size() + world.remote.size(), world.activeChunkCount(), world.chunkCount());
+    std::printf("  spatial sorts: %llu%s  row gap at end: %.1f\n",
+                static_cast<unsigned long long>(world.sortCount() - sortsBefore),
+                options.spatialSorting ? "" : " (disabled)", world.rowGap());
+    std::printf("  heap allocations in steady state: %llu (%.3f/tick, %llu bytes)\n",
+                static_cast<unsigned long long>(allocations), ticks > 0 ? allocations / ticks : 0.0,
+                static_cast<unsigned long long>(after.bytes - before.bytes));
+    std::printf("  frame arena: peak %zu of %zu bytes, overflows %llu\n",
+                world.arena().peak(), world.arena().capacity(),
+                static_cast<unsigned long long>(world.arena().overflows()));
+    printFootprint(world);
+}
+
+/**
+ * @brief Run one scene and print its report
+ *
+ * @return false if the scene can not be loaded
+ */
+static bool benchScene(const std::string& filename, const BenchOptions& options, const PerfCounters& counters) {
+    Scene scene;
+    if (!loadScene(filename, scene)) {
+        std::fprintf(stderr, "Cannot open file for reading: %s\n", filename.c_str());
+        return false;
+    }
+
+    World world;
+    populateWorld(world, scene);
+    benchWorld(filename, world, options, counters);
+    return true;
+}
+
+/**
+ * @brief Entry point of the headless benchmark
+ *
+ * @param argc number of arguments following --bench
+ * @param argv arguments following --bench
+ * @return int exit code
+ */
+int runBenchmark(int argc, char *argv[]) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: simulation --bench [--ticks N] [--warmup N] [--no-sort] [--phases] [--fixed] "
+                             "[--sense-interval N] [--kinetic] [--far-interval N] [--generate OBSTACLES ROBOTS] [scene.txt...]\n");
+        return 2;
+    }
+
+    PerfCounters counters;
+    if (!counters.available()) {
+        std::printf("hardware counters unavailable (%s), reporting timings only\n", counters.error().c_str());
+    }
+
+    bool ok = true;
+    if (options.generatedObstacles > 0 || options.generatedRobots > 0) {
+        World world;
+        generateWorld(world, options.generatedObstacles, options.generatedRobots);
+        benchWorld("generated " + std::to_string(options.generatedObstacles) + " obstacles, "
+                   + std::to_string(options.generatedRobots) + " robots", world, options, counters);
+    }
+    for (const std::string& filename : options.scenes) {
+        ok = benchScene(filename, options, counters) && ok;
+    }
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Heading math of one robot tick with libm: motion step and field of vision from degrees
+ */
+static double headingWithLibm(int orientation, double speed, double detectionRadius) {
+    double radAngle = orientation * M_PI / 180;
+    double x = speed * cos(radAngle);
+    double y = speed * sin(radAngle);
+
+    Vec2 local[4];
+    double halfTopWidth = detectionRadius * tan(M_PI / 6);
+    double halfBaseWidth = std::fmin(halfTopWidth / 4, robotRadius / 3);
+    local[0] = Vec2{robotRadius, -halfBaseWidth};
+    local[1] = Vec2{robotRadius, halfBaseWidth};
+    local[2] = Vec2{detectionRadius + robotRadius, halfTopWidth};
+    local[3] = Vec2{detectionRadius + robotRadius, -halfTopWidth};
+    for (const Vec2& corner : local) {
+        Vec2 rotated = rotatePoint(corner, radAngle);
+        x += rotated.x;
+        y += rotated.y;
+    }
+    return x + y;
+}
+
+/**
+ * @brief The same heading math with the unit vector table and a precomputed local field of vision
+ */
+static double headingWithTable(int orientation, double speed, const Vec2 local[4]) {
+    UnitVector direction = unitVector(orientation);
+    double x = speed * double(direction.x);
+    double y = speed * double(direction.y);
+
+    Vec2 view[4];
+    rotateQuad(local, direction, view);
+    for (const Vec2& corner : view) {
+        x += corner.x;
+        y += corner.y;
+    }
+    return x + y;
+}
+
+/**
+ * @brief Entry point of the heading math microbenchmark
+ * @details compares libm sin/cos/tan per robot with the table lookup used by the engine
+ * and reports the largest difference of the unit vectors
+ *
+ * @param argc number of arguments following --bench-trig
+ * @param argv arguments following --bench-trig
+ * @return int exit code
+ */
+int runTrigBenchmark(int argc, char *argv[]) {
+    long headings = 1000000;
+    long rounds = 20;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--headings" || arg == "--rounds") && i + 1 < argc) {
+            long value = std::strtol(argv[++i], nullptr, 10);
+            if (value <= 0) {
+                headings = 0;
+                break;
+            }
+            (arg == "--headings" ? headings : rounds) = value;
+        } else {
+            headings = 0;
+            break;
+        }
+    }
+    if (headings == 0) {
+        std::fprintf(stderr, "usage: simulation --bench-trig [--headings N] [--rounds N]\n");
+        return 2;
+    }
+
+    std::mt19937 random(42);
+    std::vector<std::uint16_t> orientations(headings);
+    for (std::uint16_t& orientation : orientations) {
+        orientation = static_cast<std::uint16_t>(random() % 360);
+    }
+    const double speed = 7;
+    const double detectionRadius = 50;
+    Vec2 local[4];
+    localFieldOfView(detectionRadius, local);
+
+    double checksum[2] = {};
+    double seconds[2] = {};
+    for (int method = 0; method < 2; ++method) {
+        auto started = std::chrono::steady_clock::now();
+        for (long round = 0; round < rounds; ++round) {
+            for (std::uint16_t orientation : orientations) {
+                checksum[method] += method == 0 ? headingWithLibm(orientation, speed, detectionRadius)
+                                                : headingWithTable(orientation, speed, local);
+            }
+        }
+        seconds[method] = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    }
+
+    double maxError = 0;
+    for (int degrees = 0; degrees < 360; ++degrees) {
+        double radAngle = degrees * M_PI / 180;
+        UnitVector direction = unitVector(degrees);
+        maxError = std::fmax(maxError, std::fabs(direction.x - cos(radAngle)));
+        maxError = std::fmax(maxError, std::fabs(direction.y - sin(radAngle)));
+    }
+
+    double operations = double(headings) * rounds;
+    std::printf("heading math, %ld headings x %ld rounds\n", headings, rounds);
+    std::printf("  libm sin/cos/tan: %.2f ns/robot  (checksum %.6g)\n", seconds[0] * 1e9 / operations, checksum[0]);
+    std::printf("  unit vector table: %.2f ns/robot  (checksum %.6g)\n", seconds[1] * 1e9 / operations, checksum[1]);
+    std::printf("  speedup %.2fx, max table error %.3g\n", seconds[0] / seconds[1], maxError);
+    return 0;
+}
@@ -0,0 +1,13 @@
+/**
+ * @file bench.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Headless benchmark of the simulation engine
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+int runBenchmark(int argc, char *argv[]);
+int runTrigBenchmark(int argc, char *argv[]);
+
+#endif // BENCH_H
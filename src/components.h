@@ -0,0 +1,117 @@
+/**
+ * @file components.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Components the robot archetypes are built from
+ * @details components are kept small on purpose: positions are floats, the
+ * orientation is a 16-bit count of degrees and the per-robot parameters
+ * are shared blocks referenced by index
+ */
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <cstdint>
+#include "fixedpoint.h"
+#include "geometry.h"
+#include "slotmap.h"
+
+/**
+ * @brief Kinds of robots, every kind is stored in its own archetype table
+ */
+enum class RobotKind : std::uint8_t {
+    Autonomous,
+    Remote
+};
+
+/**
+ * @brief enum for the rotation direction
+ */
+enum RotationDirection : std::uint8_t {
+    NoRotation,
+    RotateLeft,
+    RotateRight
+};
+
+/**
+ * @brief Handle of the entity, kept next to the components so that a swap-remove
+ * can update the slot of the moved entity
+ */
+struct Identity {
+    Handle handle;
+};
+
+struct Position {
+    float x, y;
+};
+
+/**
+ * @brief Orientation of the robot in whole degrees, always in [0, 360)
+ */
+struct Heading {
+    std::uint16_t orientation;
+};
+
+/**
+ * @brief Index of the shared parameter block of the robot
+ */
+struct Params {
+    std::uint32_t block;
+};
+
+/**
+ * @brief Ticks the robot is known not to detect anything, its sensor is skipped meanwhile
+ * @details see World::setSenseInterval()
+ */
+struct SenseSchedule {
+    std::uint16_t idleTicks = 0;
+};
+
+/**
+ * @brief Sleeping robots are not simulated until they are woken up
+ * @details stopped remote robots sleep until a command, parked autonomous robots
+ * (speed 0) until something can enter their field of vision, see World::step()
+ */
+struct Activity {
+    bool asleep = false;
+};
+
+/**
+ * @brief State set by the operator commands
+ */
+struct RemoteControl {
+    bool isMoving = false;
+    RotationDirection rotationDirection = NoRotation;
+};
+
+/**
+ * @brief Square obstacle given by its center and half of its size
+ */
+struct ObstacleShape {
+    float x, y, halfWidth;
+
+    Box box() const {
+        return Box{double(x) - halfWidth, double(y) - halfWidth, double(x) + halfWidth, double(y) + halfWidth};
+    }
+};
+
+/**
+ * @brief Parameters shared by all robots configured the same way (flyweight)
+ * @details constants derived from the parameters are computed once per block
+ */
+struct ParamBlock {
+    float detectionRadius;  // Radius in which the robot detects obstacles
+    float avoidanceAngle;  // Angle to turn for obstacle avoidance (autonomous robots)
+    std::int32_t speed;
+    Vec2 localView[4];  // field of vision at orientation 0, see localFieldOfView()
+    FixedVec fixedView[4];  // the same in fixed point units
+};
+
+/**
+ * @brief Wrap angle in degrees to [0, 360)
+ */
+inline std::uint16_t normalizeDegrees(int degrees) {
+    degrees %= 360;
+    return static_cast<std::uint16_t>(degrees < 0 ? degrees + 360 : degrees);
+}
+
+#endif // COMPONENTS_H
@@ -9,9 +9,10 @@
 /**
  * @brief constructor of the CreateRobotDialog class
  * 
+ * @param area scene area the coordinates must lie in
  * @param parent 
  */
-CreateRobotDialog::CreateRobotDialog(QWidget *parent) : QDialog(parent) {
+CreateRobotDialog::CreateRobotDialog(const QRectF& area, QWidget *parent) : QDialog(parent), area(area) {
     setupForm();
     setupConnections();
 }
@@ -71,8 +72,8 @@ void CreateRobotDialog::setupForm() {
 void CreateRobotDialog::validateInputs() {
     bool inputsValid = !xInput->text().isEmpty() && !yInput->text().isEmpty() &&
                        !speedInput->text().isEmpty();
-    bool xValid = xInput->text().toInt() <= 1500 && xInput->text().toInt() >= 0;
-    bool yValid = yInput->text().toInt() <= 600 && yInput->text().toInt() >= 0;
+    bool xValid = xInput->text().toInt() <= area.right() && xInput->text().toInt() >= area.left();
+    bool yValid = yInput->text().toInt() <= area.bottom() && yInput->text().toInt() >= area.top();
     bool radiusValid = detectionRadiusInput->text().toDouble() > 0;
     bool angleValid = avoidanceAngleInput->text().toDouble() > 0;
     if (getRobotType() == 1 && !angleValid){
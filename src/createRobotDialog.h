@@ -10,6 +10,7 @@
 #include <QComboBox>
 #include <QLineEdit>
 #include <QPushButton>
+#include <QRectF>
 #include <QFormLayout>
 #include <QLabel>
 #include <QTimer>
@@ -22,7 +23,7 @@ class CreateRobotDialog : public QDialog {
     Q_OBJECT
 
 public:
-    explicit CreateRobotDialog(QWidget *parent = nullptr);
+    explicit CreateRobotDialog(const QRectF& area, QWidget *parent = nullptr);
     virtual ~CreateRobotDialog();
     int getRobotType() const;
     int getOrientation() const; // Only for Autonomous
@@ -43,6 +44,7 @@ private:
     QLineEdit *avoidanceAngleInput;
     QPushButton *createButton;
     QTimer* validationTimer;
+    QRectF area;  // scene area the coordinates must lie in
     void validateInputs();
 
     void setupForm();
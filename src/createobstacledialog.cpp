@@ -9,9 +9,10 @@
 /**
  * @brief constructor of the CreateObstacleDialog class
  * 
+ * @param area scene area the coordinates must lie in
  * @param parent 
  */
-CreateObstacleDialog::CreateObstacleDialog(QWidget *parent) : QDialog(parent)
+CreateObstacleDialog::CreateObstacleDialog(const QRectF& area, QWidget *parent) : QDialog(parent), area(area)
 {
     xInput = new QLineEdit(this);
     yInput = new QLineEdit(this);
@@ -42,8 +43,8 @@ CreateObstacleDialog::CreateObstacleDialog(QWidget *parent) : QDialog(parent)
 void CreateObstacleDialog::validateInputs() {
     bool inputsValid = !xInput->text().isEmpty() && !yInput->text().isEmpty() &&
                        !widthInput->text().isEmpty();
-    bool xValid = xInput->text().toInt() <= 1500 && xInput->text().toInt() >= 0;
-    bool yValid = yInput->text().toInt() <= 600 && yInput->text().toInt() >= 0;
+    bool xValid = xInput->text().toInt() <= area.right() && xInput->text().toInt() >= area.left();
+    bool yValid = yInput->text().toInt() <= area.bottom() && yInput->text().toInt() >= area.top();
     bool widthValid = widthInput->text().toDouble() > 0;
 
     createButton->setEnabled(inputsValid && xValid && yValid && widthValid);
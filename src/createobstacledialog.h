@@ -9,6 +9,7 @@
 #include <QDialog>
 #include <QLineEdit>
 #include <QPushButton>
+#include <QRectF>
 #include <QFormLayout>
 
 /**
@@ -20,7 +21,7 @@ class CreateObstacleDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit CreateObstacleDialog(QWidget *parent = nullptr);
+    explicit CreateObstacleDialog(const QRectF& area, QWidget *parent = nullptr);
     virtual ~CreateObstacleDialog();
 
     int getX() const;
@@ -33,6 +34,7 @@ private:
     QLineEdit *widthInput;
     QPushButton *createButton;
     QTimer* validationTimer;
+    QRectF area;  // scene area the coordinates must lie in
 
 private slots:
     void on_createButton_clicked();
@@ -0,0 +1,273 @@
+/**
+ * @file ensemble.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Monte Carlo ensemble of randomly perturbed replicas of a scene
+ * @details usage: simulation --ensemble K [--seed S] [--jitter PX] [--turn DEG] [--noise P]
+ * [--ticks T] [--threads N] [--replica I] scene.txt
+ *
+ * Every replica moves each robot of the scene by up to jitter px, turns it by up to turn
+ * degrees and lets the sensors miss a detection with probability P (World::setSensorNoise()).
+ * All randomness of replica i comes from its own seed derived from S and i, so any replica
+ * can be run again alone with --replica i. The threads of the pool take the next replica
+ * when they finish one and the metrics (see MetricsProbe) are folded into streaming
+ * statistics in replica order, so the memory does not grow with K and the report does
+ * not depend on the number of threads.
+ */
+#include "ensemble.h"
+#include "metrics.h"
+#include "scene.h"
+#include "stats.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+static constexpr std::size_t reportedOutliers = 5;
+
+/**
+ * @brief Options of the ensemble
+ */
+struct EnsembleOptions {
+    long replicas = 0;
+    std::uint64_t seed = 1;
+    double jitter = 20;  // px
+    int turn = 15;  // degrees
+    double noise = 0;  // probability a detection is missed
+    long ticks = 1000;
+    unsigned threads = std::thread::hardware_concurrency();
+    long replica = -1;  // run only this replica
+    std::string scene;
+};
+
+/**
+ * @brief Outcome of one replica
+ */
+struct ReplicaResult {
+    long index;
+    std::uint64_t seed;
+    RunMetrics metrics;
+    double ticksPerSecond;
+    std::uint64_t hash;
+};
+
+/**
+ * @brief Streaming summary of one metric over the replicas
+ */
+struct MetricSummary {
+    RunningStats stats;
+    QuantileEstimator median{0.5};
+    QuantileEstimator p90{0.9};
+    QuantileEstimator p99{0.99};
+
+    void add(double value) {
+        stats.add(value);
+        median.add(value);
+        p90.add(value);
+        p99.add(value);
+    }
+};
+
+/**
+ * @brief Seed of the replica, neighbouring replicas get unrelated seeds (splitmix64)
+ */
+static std::uint64_t replicaSeed(std::uint64_t seed, long index) {
+    std::uint64_t value = seed + std::uint64_t(index + 1) * 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief Parse command line arguments following --ensemble
+ *
+ * @return false on invalid arguments
+ */
+static bool parseOptions(int argc, char *argv[], EnsembleOptions& options) {
+    if (argc < 1) return false;
+    options.replicas = std::strtol(argv[0], nullptr, 10);
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 0);
+        } else if (arg == "--jitter" && i + 1 < argc) {
+            options.jitter = std::strtod(argv[++i], nullptr);
+            if (options.jitter < 0) return false;
+        } else if (arg == "--turn" && i + 1 < argc) {
+            options.turn = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+            if (options.turn < 0 || options.turn > 180) return false;
+        } else if (arg == "--noise" && i + 1 < argc) {
+            options.noise = std::strtod(argv[++i], nullptr);
+            if (options.noise < 0 || options.noise > 1) return false;
+        } else if ((arg == "--ticks" || arg == "--threads") && i + 1 < argc) {
+            long value = std::strtol(argv[++i], nullptr, 10);
+            if (value <= 0) return false;
+            if (arg == "--ticks") options.ticks = value;
+            else options.threads = static_cast<unsigned>(value);
+        } else if (arg == "--replica" && i + 1 < argc) {
+            options.replica = std::strtol(argv[++i], nullptr, 10);
+            if (options.replica < 0) return false;
+        } else if (!arg.empty() && arg[0] != '-' && options.scene.empty()) {
+            options.scene = arg;
+        } else {
+            return false;
+        }
+    }
+    return options.replicas > 0 && !options.scene.empty() && options.replica < options.replicas;
+}
+
+/**
+ * @brief Build the perturbed world of the replica and run it
+ *
+ * @param prototype world of the unperturbed scene, the replica shares its obstacle grid
+ */
+static ReplicaResult runReplica(const EnsembleOptions& options, const Scene& scene, World& prototype, long index) {
+    ReplicaResult result{index, replicaSeed(options.seed, index), RunMetrics{}, 0, 0};
+    World world;
+    populateWorld(world, scene);
+    world.shareObstacles(prototype);
+
+    // only the raw output of the generator is used, the same seed gives the same replica with every standard library
+    std::mt19937_64 random(result.seed);
+    auto uniform = [&](double limit) { return (random() / 18446744073709551616.0 * 2 - 1) * limit; };
+    struct Pose {
+        Handle handle;
+        Position position;
+        int orientation;
+    };
+    std::vector<Pose> poses;
+    world.forEachRobot([&](RobotKind, Handle handle, const Position& position, const Heading& heading, const ParamBlock&) {
+        poses.push_back(Pose{handle, position, heading.orientation});
+    });
+    const Box& bounds = world.bounds();
+    for (const Pose& pose : poses) {
+        double x = std::min(std::max(pose.position.x + uniform(options.jitter), bounds.minX + robotRadius), bounds.maxX - robotRadius);
+        double y = std::min(std::max(pose.position.y + uniform(options.jitter), bounds.minY + robotRadius), bounds.maxY - robotRadius);
+        int turn = options.turn > 0 ? static_cast<int>(random() % (2 * options.turn + 1)) - options.turn : 0;
+        world.setPose(pose.handle, x, y, pose.orientation + turn);
+    }
+    world.setSensorNoise(options.noise, result.seed);
+
+    MetricsProbe probe(world);
+    double stepping = 0;
+    for (long tick = 0; tick < options.ticks; ++tick) {
+        auto begin = std::chrono::steady_clock::now();
+        world.step();
+        stepping += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        probe.sample(world, result.metrics);
+    }
+    result.ticksPerSecond = stepping > 0 ? options.ticks / stepping : 0;
+    result.hash = world.stateHash();
+    return result;
+}
+
+static void printReplica(const ReplicaResult& result) {
+    std::printf("replica %ld seed 0x%016" PRIx64 ": stuck %.2f%%, longest stuck %ld, coverage %.2f%%, collisions %" PRIu64
+                ", hash %016" PRIx64 "\n", result.index, result.seed, result.metrics.stuckPercent(), result.metrics.longestStuck,
+                result.metrics.coveragePercent(), result.metrics.collisions, result.hash);
+}
+
+static void printSummary(const char* name, const MetricSummary& summary) {
+    std::printf("%-14s mean %10.3f  stddev %10.3f  min %10.3f  p50 %10.3f  p90 %10.3f  p99 %10.3f  max %10.3f\n",
+                name, summary.stats.mean(), summary.stats.stddev(), summary.stats.min(), summary.median.value(),
+                summary.p90.value(), summary.p99.value(), summary.stats.max());
+}
+
+/**
+ * @brief Entry point of the ensemble
+ *
+ * @param argc number of arguments following --ensemble
+ * @param argv arguments following --ensemble
+ * @return int exit code
+ */
+int runEnsemble(int argc, char *argv[]) {
+    EnsembleOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: simulation --ensemble K [--seed S] [--jitter PX] [--turn DEG] [--noise P] "
+                             "[--ticks T] [--threads N] [--replica I] scene.txt\n");
+        return 2;
+    }
+    Scene scene;
+    if (!loadScene(options.scene, scene)) {
+        std::fprintf(stderr, "Cannot open file for reading: %s\n", options.scene.c_str());
+        return 2;
+    }
+    World prototype;
+    populateWorld(prototype, scene);
+    prototype.prepareObstacles();  // before the threads share its grid
+
+    if (options.replica >= 0) {
+        printReplica(runReplica(options, scene, prototype, options.replica));
+        return 0;
+    }
+
+    WorkerPool pool(options.threads);
+    std::printf("%ld replicas of %s on %u threads, %ld ticks each, seed %" PRIu64 ", jitter %.1f px, turn %d deg, noise %.3f\n",
+                options.replicas, options.scene.c_str(), pool.size(), options.ticks, options.seed,
+                options.jitter, options.turn, options.noise);
+    std::fflush(stdout);
+
+    MetricSummary stuck, longestStuck, coverage, collisions, throughput;
+    std::vector<ReplicaResult> outliers;  // most stuck replicas
+    std::map<long, ReplicaResult> pending;  // finished out of order, fewer than one per thread
+    long nextFold = 0;
+    std::mutex mutex;
+    std::condition_variable folded;
+    std::atomic<long> next{0};
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(pool.size(), [&](std::size_t, std::size_t, unsigned) {
+        for (long index = next++; index < options.replicas; index = next++) {
+            {
+                // a thread does not run ahead of the replica being folded by more than the pool size, that
+                // replica has been taken by a thread which does not wait, so the wait ends
+                std::unique_lock<std::mutex> lock(mutex);
+                folded.wait(lock, [&]() { return index < nextFold + static_cast<long>(pool.size()); });
+            }
+            ReplicaResult result = runReplica(options, scene, prototype, index);
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.emplace(index, result);
+            // fold in replica order, the quantile estimates depend on the order of the values
+            for (auto it = pending.find(nextFold); it != pending.end(); it = pending.find(nextFold)) {
+                const ReplicaResult& done = it->second;
+                stuck.add(done.metrics.stuckPercent());
+                longestStuck.add(double(done.metrics.longestStuck));
+                coverage.add(done.metrics.coveragePercent());
+                collisions.add(double(done.metrics.collisions));
+                throughput.add(done.ticksPerSecond);
+                outliers.push_back(done);
+                std::sort(outliers.begin(), outliers.end(), [](const ReplicaResult& a, const ReplicaResult& b) {
+                    return a.metrics.stuckPercent() > b.metrics.stuckPercent()
+                        || (a.metrics.stuckPercent() == b.metrics.stuckPercent() && a.index < b.index);
+                });
+                outliers.resize(std::min(outliers.size(), reportedOutliers));
+                pending.erase(it);
+                ++nextFold;
+                folded.notify_all();
+            }
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printSummary("stuck%", stuck);
+    printSummary("longest stuck", longestStuck);
+    printSummary("coverage%", coverage);
+    printSummary("collisions", collisions);
+    printSummary("ticks/sec", throughput);
+    std::printf("most stuck replicas, rerun one with --replica I:\n");
+    for (const ReplicaResult& result : outliers) {
+        std::printf("  ");
+        printReplica(result);
+    }
+    std::printf("%ld replicas in %.3f s, %.1f replicas/sec, %.1f world ticks/sec\n", options.replicas, seconds,
+                options.replicas / seconds, double(options.replicas) * options.ticks / seconds);
+    return 0;
+}
@@ -0,0 +1,12 @@
+/**
+ * @file ensemble.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Monte Carlo ensemble of randomly perturbed replicas of a scene
+ */
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+int runEnsemble(int argc, char *argv[]);
+
+#endif // ENSEMBLE_H
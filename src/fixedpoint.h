@@ -0,0 +1,139 @@
+/**
+ * @file fixedpoint.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Integer geometry of the fixed point engine mode
+ * @details positions are whole multiples of 1/16 px, all arithmetic on them is
+ * done in integers, so results are the same on every machine and compiler
+ */
+#ifndef FIXEDPOINT_H
+#define FIXEDPOINT_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "geometry.h"
+#include "trig.h"
+
+constexpr std::int64_t fixedOne = 16;  // fixed point units per pixel
+constexpr double fixedLimit = 1 << 20;  // larger coordinates (px) are not exact in the float columns
+
+/**
+ * @brief Point in fixed point units
+ */
+struct FixedVec {
+    std::int64_t x, y;
+};
+
+/**
+ * @brief Axis aligned box in fixed point units
+ */
+struct FixedBox {
+    std::int64_t minX, minY, maxX, maxY;
+};
+
+/**
+ * @brief Divide rounding to nearest, halves away from zero
+ *
+ * @param denominator positive divisor
+ */
+constexpr std::int64_t divRound(std::int64_t numerator, std::int64_t denominator) {
+    return numerator >= 0 ? (numerator + denominator / 2) / denominator
+                          : -((-numerator + denominator / 2) / denominator);
+}
+
+/**
+ * @brief Nearest fixed point value of the coordinate in pixels
+ */
+inline std::int64_t toFixed(double pixels) {
+    return std::llround(pixels * fixedOne);
+}
+
+/**
+ * @brief Coordinate in pixels, exact for every fixed point value below fixedLimit
+ */
+inline double fromFixed(std::int64_t units) {
+    return double(units) / fixedOne;
+}
+
+inline FixedBox toFixed(const Box& box) {
+    return FixedBox{toFixed(box.minX), toFixed(box.minY), toFixed(box.maxX), toFixed(box.maxY)};
+}
+
+inline Box fromFixed(const FixedBox& box) {
+    return Box{fromFixed(box.minX), fromFixed(box.minY), fromFixed(box.maxX), fromFixed(box.maxY)};
+}
+
+/**
+ * @brief Rotate point around the origin by whole degrees using the Q14 tables
+ */
+inline FixedVec fixedRotate(FixedVec point, int degrees) {
+    std::int64_t c = fixedCos(degrees);
+    std::int64_t s = fixedSin(degrees);
+    return FixedVec{divRound(c * point.x - s * point.y, trigOne), divRound(s * point.x + c * point.y, trigOne)};
+}
+
+/**
+ * @brief Field of vision of a robot facing right in fixed point units, see localFieldOfView()
+ */
+inline void fixedLocalFieldOfView(double detectionRadius, FixedVec corners[4]) {
+    std::int64_t radius = toFixed(detectionRadius);
+    std::int64_t body = toFixed(robotRadius);
+    std::int64_t halfTopWidth = divRound(radius * tan30, trigOne);
+    std::int64_t halfBaseWidth = std::min(halfTopWidth / 4, body / 3);
+
+    corners[0] = FixedVec{body, -halfBaseWidth};
+    corners[1] = FixedVec{body, halfBaseWidth};
+    corners[2] = FixedVec{radius + body, halfTopWidth};
+    corners[3] = FixedVec{radius + body, -halfTopWidth};
+}
+
+inline FixedBox fixedBoundsOf(const FixedVec quad[4]) {
+    FixedBox box{quad[0].x, quad[0].y, quad[0].x, quad[0].y};
+    for (int i = 1; i < 4; ++i) {
+        box.minX = std::min(box.minX, quad[i].x);
+        box.minY = std::min(box.minY, quad[i].y);
+        box.maxX = std::max(box.maxX, quad[i].x);
+        box.maxY = std::max(box.maxY, quad[i].y);
+    }
+    return box;
+}
+
+/**
+ * @brief Separating axis test of a convex quad against an axis aligned box in integers
+ *
+ * @return true when the shapes overlap or touch
+ */
+inline bool fixedQuadIntersectsBox(const FixedVec quad[4], const FixedBox& box) {
+    // box axes
+    FixedBox quadBox = fixedBoundsOf(quad);
+    if (quadBox.maxX < box.minX || quadBox.minX > box.maxX ||
+        quadBox.maxY < box.minY || quadBox.minY > box.maxY) {
+        return false;
+    }
+
+    // quad edge normals
+    for (int i = 0; i < 4; ++i) {
+        const FixedVec& a = quad[i];
+        const FixedVec& b = quad[(i + 1) % 4];
+        FixedVec axis{a.y - b.y, b.x - a.x};
+
+        std::int64_t quadMin = INT64_MAX, quadMax = INT64_MIN;
+        for (int j = 0; j < 4; ++j) {
+            std::int64_t p = quad[j].x * axis.x + quad[j].y * axis.y;
+            quadMin = std::min(quadMin, p);
+            quadMax = std::max(quadMax, p);
+        }
+
+        // extreme corners of the box along the axis
+        std::int64_t boxMin = (axis.x >= 0 ? box.minX : box.maxX) * axis.x + (axis.y >= 0 ? box.minY : box.maxY) * axis.y;
+        std::int64_t boxMax = (axis.x >= 0 ? box.maxX : box.minX) * axis.x + (axis.y >= 0 ? box.maxY : box.minY) * axis.y;
+
+        if (quadMax < boxMin || boxMax < quadMin) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // FIXEDPOINT_H
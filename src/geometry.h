@@ -0,0 +1,201 @@
+/**
+ * @file geometry.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Plain geometry helpers shared by the simulation engine and the views
+ */
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <cmath>
+#include "trig.h"
+
+/**
+ * @brief 2D vector / point
+ */
+struct Vec2 {
+    double x, y;
+};
+
+/**
+ * @brief Axis aligned box given by its min and max corners
+ */
+struct Box {
+    double minX, minY, maxX, maxY;
+};
+
+constexpr double robotRadius = 20; // half of the robot body size
+constexpr double tanHalfFieldOfView = 0.5773502691896257; // tan(30 deg), half angle of the field of vision
+
+/**
+ * @brief Rotate point around the origin
+ *
+ * @param point point to rotate
+ * @param angle angle in radians
+ */
+inline Vec2 rotatePoint(Vec2 point, double angle) {
+    return Vec2{cos(angle) * point.x - sin(angle) * point.y,
+                sin(angle) * point.x + cos(angle) * point.y};
+}
+
+/**
+ * @brief Rotate all corners of a quad around the origin
+ *
+ * @param direction unit vector of the rotation angle
+ */
+inline void rotateQuad(const Vec2 quad[4], UnitVector direction, Vec2 rotated[4]) {
+    double c = direction.x;
+    double s = direction.y;
+    for (int i = 0; i < 4; ++i) {
+        rotated[i] = Vec2{c * quad[i].x - s * quad[i].y, s * quad[i].x + c * quad[i].y};
+    }
+}
+
+/**
+ * @brief Compute the trapezoid field of vision of a robot facing right (orientation 0)
+ * @details corners are written in order base left, base right, top right, top left
+ *
+ * @param detectionRadius length of the field of vision
+ * @param corners output array of 4 corners
+ */
+inline void localFieldOfView(double detectionRadius, Vec2 corners[4]) {
+    double halfTopWidth = detectionRadius * tanHalfFieldOfView; // Half width at the detection radius
+    double halfBaseWidth = halfTopWidth / 4;  // Half width at the robot
+    if (halfBaseWidth > robotRadius / 3) {
+        halfBaseWidth = robotRadius / 3;
+    }
+
+    corners[0] = Vec2{robotRadius, -halfBaseWidth};
+    corners[1] = Vec2{robotRadius, halfBaseWidth};
+    corners[2] = Vec2{detectionRadius + robotRadius, halfTopWidth};
+    corners[3] = Vec2{detectionRadius + robotRadius, -halfTopWidth};
+}
+
+/**
+ * @brief Local field of vision grown to cover every copy of it moved forward by up to length
+ * and sideways by up to margin
+ * @details the sides keep their slope and move out by margin, the far side moves forward by
+ * length + margin, so the result contains the field of vision at each position of a robot
+ * driving straight ahead, see World::runBehavior()
+ *
+ * @param local field of vision from localFieldOfView()
+ * @param swept output array of 4 corners in the same order
+ */
+inline void sweptFieldOfView(const Vec2 local[4], double length, double margin, Vec2 swept[4]) {
+    double baseX = local[1].x;
+    double topX = local[2].x;
+    double baseHalfWidth = local[1].y;
+    double slope = topX > baseX ? (local[2].y - baseHalfWidth) / (topX - baseX) : 0;
+
+    double sweptBaseX = baseX - margin;
+    double sweptTopX = topX + length + margin;
+    double sweptBaseHalfWidth = baseHalfWidth + margin - slope * margin;
+    double sweptTopHalfWidth = baseHalfWidth + margin + slope * (sweptTopX - baseX);
+    swept[0] = Vec2{sweptBaseX, -sweptBaseHalfWidth};
+    swept[1] = Vec2{sweptBaseX, sweptBaseHalfWidth};
+    swept[2] = Vec2{sweptTopX, sweptTopHalfWidth};
+    swept[3] = Vec2{sweptTopX, -sweptTopHalfWidth};
+}
+
+/**
+ * @brief Compute the trapezoid field of vision in robot local space
+ * @details corners are written in order base left, base right, top right, top left
+ *
+ * @param detectionRadius length of the field of vision
+ * @param orientation robot orientation in degrees
+ * @param corners output array of 4 corners
+ */
+inline void fieldOfView(double detectionRadius, int orientation, Vec2 corners[4]) {
+    Vec2 local[4];
+    localFieldOfView(detectionRadius, local);
+    rotateQuad(local, unitVector(orientation), corners);
+}
+
+/**
+ * @brief Bounding box of a quad
+ */
+inline Box boundsOf(const Vec2 quad[4]) {
+    Box box{quad[0].x, quad[0].y, quad[0].x, quad[0].y};
+    for (int i = 1; i < 4; ++i) {
+        box.minX = std::fmin(box.minX, quad[i].x);
+        box.minY = std::fmin(box.minY, quad[i].y);
+        box.maxX = std::fmax(box.maxX, quad[i].x);
+        box.maxY = std::fmax(box.maxY, quad[i].y);
+    }
+    return box;
+}
+
+/**
+ * @brief Check if inner box lies completely inside outer box (edges included)
+ */
+inline bool boxContains(const Box& outer, const Box& inner) {
+    return inner.minX >= outer.minX && inner.maxX <= outer.maxX &&
+           inner.minY >= outer.minY && inner.maxY <= outer.maxY;
+}
+
+/**
+ * @brief Check if two boxes overlap or touch
+ */
+inline bool boxesIntersect(const Box& a, const Box& b) {
+    return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+}
+
+/**
+ * @brief Check if the point lies inside the box (edges included)
+ */
+inline bool boxContains(const Box& box, double x, double y) {
+    return x >= box.minX && x <= box.maxX && y >= box.minY && y <= box.maxY;
+}
+
+/**
+ * @brief Box of the robot body centered at the given point
+ */
+inline Box robotBox(double x, double y) {
+    return Box{x - robotRadius, y - robotRadius, x + robotRadius, y + robotRadius};
+}
+
+/**
+ * @brief Separating axis test of a convex quad against an axis aligned box
+ *
+ * @return true when the shapes overlap or touch
+ */
+inline bool quadIntersectsBox(const Vec2 quad[4], const Box& box) {
+    // box axes
+    Box quadBox = boundsOf(quad);
+    if (quadBox.maxX < box.minX || quadBox.minX > box.maxX ||
+        quadBox.maxY < box.minY || quadBox.minY > box.maxY) {
+        return false;
+    }
+
+    // quad edge normals
+    for (int i = 0; i < 4; ++i) {
+        const Vec2& a = quad[i];
+        const Vec2& b = quad[(i + 1) % 4];
+        Vec2 axis{a.y - b.y, b.x - a.x};
+
+        double quadMin = INFINITY, quadMax = -INFINITY;
+        for (int j = 0; j < 4; ++j) {
+            double p = quad[j].x * axis.x + quad[j].y * axis.y;
+            quadMin = std::fmin(quadMin, p);
+            quadMax = std::fmax(quadMax, p);
+        }
+
+        double cornersX[2] = {box.minX, box.maxX};
+        double cornersY[2] = {box.minY, box.maxY};
+        double boxMin = INFINITY, boxMax = -INFINITY;
+        for (double cx : cornersX) {
+            for (double cy : cornersY) {
+                double p = cx * axis.x + cy * axis.y;
+                boxMin = std::fmin(boxMin, p);
+                boxMax = std::fmax(boxMax, p);
+            }
+        }
+
+        if (quadMax < boxMin || boxMax < quadMin) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // GEOMETRY_H
@@ -0,0 +1,555 @@
+/**
+ * @file jobserver.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Local job server running headless simulations in worker processes and its client
+ * @details usage:
+ *   simulation --serve [--socket PATH] [--workers N] [--dir DIR] [--retries R]
+ *   simulation --submit [--socket PATH] [--ticks T] [--every K] [--fixed] [--kinetic] [--sense-interval N] scene.txt
+ *   simulation --status [--socket PATH] [--shutdown] [JOB]
+ *
+ * The server listens on a Unix socket and runs up to N jobs at once, each in a forked
+ * worker process. A job runs the scene headless, records its trace to DIR/job-ID.trace
+ * (see trace.h) and writes the hash and the metrics of the run (see MetricsProbe) to
+ * DIR/job-ID.result. A worker killed by a signal or failing otherwise than on an
+ * unreadable scene is retried up to R times. The client sends one request line and
+ * prints the reply: SUBMIT options scene, STATUS [id] or SHUTDOWN.
+ */
+#include "jobserver.h"
+#include "metrics.h"
+#include "scene.h"
+#include "threadpool.h"
+#include "trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <climits>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * @brief Run options of a job
+ */
+struct JobOptions {
+    long ticks = 1000;
+    long every = 100;  // ticks between two recorded states
+    bool fixedPoint = false;
+    bool kinetic = false;
+    long senseInterval = 1;
+};
+
+enum class JobState { Queued, Running, Done, Failed };
+
+/**
+ * @brief Job of the server
+ */
+struct Job {
+    long id;
+    std::string scene;  // absolute path
+    JobOptions options;
+    JobState state = JobState::Queued;
+    int attempts = 0;
+    pid_t worker = -1;
+    std::string result;  // content of the result file or the reason of the failure
+    std::chrono::steady_clock::time_point started;
+    double seconds = 0;  // of the last attempt
+};
+
+static constexpr long requestTimeout = 500;  // ms a client gets to send its request and to read the reply
+static constexpr std::size_t maxRequest = 4096;  // bytes of a request line
+
+static const char* stateName(JobState state) {
+    switch (state) {
+        case JobState::Queued: return "queued";
+        case JobState::Running: return "running";
+        case JobState::Done: return "done";
+        default: return "failed";
+    }
+}
+
+/**
+ * @brief Default socket of the user, e.g. /tmp/simulation-jobs-1000.sock
+ */
+static std::string defaultSocket() {
+    return "/tmp/simulation-jobs-" + std::to_string(getuid()) + ".sock";
+}
+
+static bool socketAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) return false;
+    std::strcpy(address.sun_path, path.c_str());
+    return true;
+}
+
+/**
+ * @brief Run the job in the worker process
+ *
+ * @return exit code of the worker, 1 when the scene can not be read, such jobs are not retried
+ */
+static int runJob(const Job& job, const std::string& directory) {
+    Scene scene;
+    if (!loadScene(job.scene, scene)) {
+        std::fprintf(stderr, "Cannot open file for reading: %s\n", job.scene.c_str());
+        return 1;
+    }
+    World world;
+    populateWorld(world, scene);
+    world.setFixedPoint(job.options.fixedPoint || world.fixedPoint());
+    if (job.options.senseInterval > 1) {
+        world.setSenseInterval(RobotKind::Autonomous, static_cast<int>(job.options.senseInterval));
+        world.setSenseInterval(RobotKind::Remote, static_cast<int>(job.options.senseInterval));
+    }
+    world.setKineticScheduling(job.options.kinetic || world.kineticScheduling());
+
+    std::string prefix = directory + "/job-" + std::to_string(job.id);
+    std::FILE* trace = std::fopen((prefix + ".trace").c_str(), "w");
+    if (!trace) {
+        return 2;
+    }
+    WorkerPool pool(1);
+    TraceWriter writer(trace, pool);
+    writer.writeHeader(job.scene, job.options.every);
+    writer.writeTick(0, world);
+    MetricsProbe probe(world);
+    RunMetrics metrics;
+    double stepping = 0;
+    for (long tick = 1; tick <= job.options.ticks; ++tick) {
+        auto begin = std::chrono::steady_clock::now();
+        world.step();
+        stepping += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        probe.sample(world, metrics);
+        if (tick % job.options.every == 0) {
+            writer.writeTick(tick, world);
+        }
+    }
+    std::fclose(trace);
+
+    // written aside and renamed, so the server never reads a partial result
+    std::FILE* result = std::fopen((prefix + ".result.part").c_str(), "w");
+    if (!result) {
+        return 2;
+    }
+    std::fprintf(result, "hash %016" PRIx64 " ticks/sec %.1f stuck%% %.2f longest %ld coverage%% %.2f collisions %" PRIu64 "\n",
+                 world.stateHash(), stepping > 0 ? job.options.ticks / stepping : 0.0, metrics.stuckPercent(),
+                 metrics.longestStuck, metrics.coveragePercent(), metrics.collisions);
+    std::fclose(result);
+    return std::rename((prefix + ".result.part").c_str(), (prefix + ".result").c_str()) == 0 ? 0 : 2;
+}
+
+/**
+ * @brief Id following the highest job id found in the directory
+ */
+static long nextJobId(const std::string& directory) {
+    long id = 0;
+    if (DIR* listing = opendir(directory.c_str())) {
+        while (dirent* entry = readdir(listing)) {
+            if (std::strncmp(entry->d_name, "job-", 4) == 0) {
+                id = std::max(id, std::strtol(entry->d_name + 4, nullptr, 10));
+            }
+        }
+        closedir(listing);
+    }
+    return id + 1;
+}
+
+/**
+ * @class JobServer
+ * @brief Queue of jobs, its worker processes and the request handling
+ */
+class JobServer {
+public:
+    JobServer(std::string directory, int workers, int retries, long firstId)
+        : directory(std::move(directory)), workers(workers), retries(retries), firstId(firstId) {}
+
+    int serve(int listener);
+
+private:
+    std::string directory;
+    int workers;
+    int retries;
+    long firstId;  // jobs of earlier servers in the directory are not overwritten
+    std::vector<Job> jobs;
+    int running = 0;
+    bool stopping = false;
+
+    void startJobs(int listener);
+    void reapWorkers();
+    std::string handle(const std::string& request);
+    std::string describe(const Job& job) const;
+};
+
+/**
+ * @brief Read the request line of a client
+ * @details the server does nothing else meanwhile, so a client gets requestTimeout ms for the whole
+ * line and maxRequest bytes, a client which connects and stays silent is dropped
+ *
+ * @return false when the client did not send a complete line in time
+ */
+static bool receiveRequest(int client, std::string& request) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(requestTimeout);
+    char buffer[512];
+    while (request.find('\n') == std::string::npos && request.size() < maxRequest) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        pollfd readable{client, POLLIN, 0};
+        if (left <= 0 || poll(&readable, 1, static_cast<int>(left)) <= 0) return false;
+        ssize_t received = read(client, buffer, sizeof(buffer));
+        if (received <= 0) return false;
+        request.append(buffer, static_cast<std::size_t>(received));
+    }
+    std::size_t end = request.find('\n');
+    if (end == std::string::npos) return false;
+    request.resize(end);
+    return true;
+}
+
+/**
+ * @brief Serve requests until SHUTDOWN
+ *
+ * @return int exit code
+ */
+int JobServer::serve(int listener) {
+    while (!stopping) {
+        reapWorkers();
+        startJobs(listener);
+        pollfd waiting{listener, POLLIN, 0};
+        if (poll(&waiting, 1, 100) <= 0) continue;  // wake up regularly to reap the workers
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) continue;
+        std::string request;
+        if (receiveRequest(client, request)) {
+            // a client which does not read its reply can not block the server either
+            timeval timeout{0, static_cast<suseconds_t>(requestTimeout * 1000)};
+            setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            std::string reply = handle(request);
+            ssize_t ignored = write(client, reply.data(), reply.size());
+            (void)ignored;  // the client may be gone
+        }
+        close(client);
+    }
+    for (const Job& job : jobs) {
+        if (job.state == JobState::Running) kill(job.worker, SIGTERM);
+    }
+    while (running > 0 && wait(nullptr) > 0) {
+        --running;
+    }
+    return 0;
+}
+
+/**
+ * @brief Fork workers for the queued jobs while there are free slots
+ */
+void JobServer::startJobs(int listener) {
+    for (Job& job : jobs) {
+        if (running >= workers) return;
+        if (job.state != JobState::Queued) continue;
+        std::fflush(stdout);
+        pid_t worker = fork();
+        if (worker < 0) return;  // try again on the next round
+        if (worker == 0) {
+            close(listener);
+            std::_Exit(runJob(job, directory));
+        }
+        job.state = JobState::Running;
+        job.worker = worker;
+        ++job.attempts;
+        job.started = std::chrono::steady_clock::now();
+        ++running;
+        std::printf("job %ld started, attempt %d\n", job.id, job.attempts);
+    }
+}
+
+/**
+ * @brief Collect the finished workers, a crashed job is queued again until it runs out of retries
+ */
+void JobServer::reapWorkers() {
+    int status = 0;
+    pid_t worker;
+    while ((worker = waitpid(-1, &status, WNOHANG)) > 0) {
+        for (Job& job : jobs) {
+            if (job.state != JobState::Running || job.worker != worker) continue;
+            --running;
+            job.worker = -1;
+            job.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - job.started).count();
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+                std::ifstream file(directory + "/job-" + std::to_string(job.id) + ".result");
+                std::getline(file, job.result);
+                job.state = JobState::Done;
+            } else if (WIFEXITED(status) && WEXITSTATUS(status) == 1) {
+                job.result = "cannot read the scene";
+                job.state = JobState::Failed;
+            } else {
+                job.result = WIFSIGNALED(status) ? "worker killed by signal " + std::to_string(WTERMSIG(status))
+                                                 : "worker exited with " + std::to_string(WEXITSTATUS(status));
+                job.state = job.attempts <= retries ? JobState::Queued : JobState::Failed;
+            }
+            std::printf("job %ld %s%s%s\n", job.id, stateName(job.state), job.result.empty() ? "" : ": ", job.result.c_str());
+        }
+    }
+    std::fflush(stdout);
+}
+
+std::string JobServer::describe(const Job& job) const {
+    std::ostringstream line;
+    line << job.id << ' ' << stateName(job.state) << " attempts " << job.attempts << " ticks " << job.options.ticks
+         << ' ' << job.scene;
+    if (job.state == JobState::Done || job.state == JobState::Failed) {
+        line << " (" << job.seconds << " s) " << job.result;
+    }
+    if (job.state == JobState::Done) {
+        line << " trace " << directory << "/job-" << job.id << ".trace";
+    }
+    return line.str() + "\n";
+}
+
+/**
+ * @brief Answer one request line
+ */
+std::string JobServer::handle(const std::string& request) {
+    std::istringstream in(request);
+    std::string command;
+    in >> command;
+    if (command == "SUBMIT") {
+        Job job;
+        job.id = firstId + static_cast<long>(jobs.size());
+        int fixedPoint = 0, kinetic = 0;
+        in >> job.options.ticks >> job.options.every >> fixedPoint >> kinetic >> job.options.senseInterval;
+        std::getline(in >> std::ws, job.scene);
+        if (!in || job.scene.empty() || job.options.ticks <= 0 || job.options.every <= 0 || job.options.senseInterval <= 0) {
+            return "error: invalid job\n";
+        }
+        job.options.fixedPoint = fixedPoint != 0;
+        job.options.kinetic = kinetic != 0;
+        jobs.push_back(job);
+        return "job " + std::to_string(job.id) + " queued\n";
+    }
+    if (command == "STATUS") {
+        long id = 0;
+        if (in >> id) {
+            long index = id - firstId;
+            return index >= 0 && index < static_cast<long>(jobs.size()) ? describe(jobs[index])
+                                                                        : "error: no job " + std::to_string(id) + "\n";
+        }
+        std::string reply;
+        for (const Job& job : jobs) {
+            reply += describe(job);
+        }
+        return reply.empty() ? "no jobs\n" : reply;
+    }
+    if (command == "SHUTDOWN") {
+        stopping = true;
+        return "shutting down\n";
+    }
+    return "error: unknown request\n";
+}
+
+/**
+ * @brief Entry point of the job server
+ *
+ * @param argc number of arguments following --serve
+ * @param argv arguments following --serve
+ * @return int exit code
+ */
+int runJobServer(int argc, char *argv[]) {
+    std::string path = defaultSocket();
+    std::string directory = "jobs";
+    long workers = std::thread::hardware_concurrency();
+    long retries = 2;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            path = argv[++i];
+        } else if (arg == "--dir" && i + 1 < argc) {
+            directory = argv[++i];
+        } else if ((arg == "--workers" || arg == "--retries") && i + 1 < argc) {
+            long value = std::strtol(argv[++i], nullptr, 10);
+            if (value < (arg == "--workers" ? 1 : 0)) workers = -1;
+            (arg == "--workers" ? workers : retries) = value;
+        } else {
+            workers = -1;
+        }
+    }
+    if (workers < 1 || retries < 0) {
+        std::fprintf(stderr, "usage: simulation --serve [--socket PATH] [--workers N] [--dir DIR] [--retries R]\n");
+        return 2;
+    }
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::perror(directory.c_str());
+        return 2;
+    }
+    char resolved[PATH_MAX];
+    if (!realpath(directory.c_str(), resolved)) {
+        std::perror(directory.c_str());
+        return 2;
+    }
+
+    sockaddr_un address;
+    if (!socketAddress(path, address)) {
+        std::fprintf(stderr, "Socket path too long: %s\n", path.c_str());
+        return 2;
+    }
+    // a socket file nobody accepts on is left over by a server which did not shut down
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool answered = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    bool stale = !answered && errno == ECONNREFUSED;
+    if (probe >= 0) close(probe);
+    if (answered) {
+        std::fprintf(stderr, "A job server is already running at %s\n", path.c_str());
+        return 2;
+    }
+    if (stale) {
+        unlink(path.c_str());
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        std::perror(path.c_str());
+        return 2;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+    std::printf("serving %s with %ld workers, results in %s\n", path.c_str(), workers, resolved);
+    std::fflush(stdout);
+
+    JobServer server(resolved, static_cast<int>(workers), static_cast<int>(retries), nextJobId(resolved));
+    int code = server.serve(listener);
+    close(listener);
+    unlink(path.c_str());
+    return code;
+}
+
+/**
+ * @brief Send one request to the server and print its reply
+ */
+static int request(const std::string& path, const std::string& line) {
+    sockaddr_un address;
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (!socketAddress(path, address) || server < 0
+        || connect(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::fprintf(stderr, "No job server at %s, start one with simulation --serve\n", path.c_str());
+        return 2;
+    }
+    std::string message = line + "\n";
+    if (write(server, message.data(), message.size()) != static_cast<ssize_t>(message.size())) {
+        close(server);
+        return 2;
+    }
+    std::string reply;
+    char buffer[4096];
+    ssize_t received;
+    while ((received = read(server, buffer, sizeof(buffer))) > 0) {
+        reply.append(buffer, static_cast<std::size_t>(received));
+    }
+    close(server);
+    std::fputs(reply.c_str(), stdout);
+    return reply.compare(0, 6, "error:") == 0 ? 1 : 0;
+}
+
+/**
+ * @brief Entry point of the client submitting a job
+ *
+ * @param argc number of arguments following --submit
+ * @param argv arguments following --submit
+ * @return int exit code
+ */
+int runJobSubmit(int argc, char *argv[]) {
+    std::string path = defaultSocket();
+    JobOptions options;
+    std::string scene;
+    bool valid = true;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            path = argv[++i];
+        } else if (arg == "--fixed") {
+            options.fixedPoint = true;
+        } else if (arg == "--kinetic") {
+            options.kinetic = true;
+        } else if ((arg == "--ticks" || arg == "--every" || arg == "--sense-interval") && i + 1 < argc) {
+            long value = std::strtol(argv[++i], nullptr, 10);
+            valid = valid && value > 0;
+            if (arg == "--ticks") options.ticks = value;
+            else if (arg == "--every") options.every = value;
+            else options.senseInterval = value;
+        } else if (!arg.empty() && arg[0] != '-' && scene.empty()) {
+            scene = arg;
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || scene.empty()) {
+        std::fprintf(stderr, "usage: simulation --submit [--socket PATH] [--ticks T] [--every K] [--fixed] [--kinetic] "
+                             "[--sense-interval N] scene.txt\n");
+        return 2;
+    }
+    char resolved[PATH_MAX];
+    if (!realpath(scene.c_str(), resolved)) {  // the server runs in another directory
+        std::fprintf(stderr, "Cannot open file for reading: %s\n", scene.c_str());
+        return 2;
+    }
+    return request(path, "SUBMIT " + std::to_string(options.ticks) + " " + std::to_string(options.every) + " "
+                             + (options.fixedPoint ? "1 " : "0 ") + (options.kinetic ? "1 " : "0 ")
+                             + std::to_string(options.senseInterval) + " " + resolved);
+}
+
+/**
+ * @brief Entry point of the client querying the jobs
+ *
+ * @param argc number of arguments following --status
+ * @param argv arguments following --status
+ * @return int exit code
+ */
+int runJobStatus(int argc, char *argv[]) {
+    std::string path = defaultSocket();
+    std::string line = "STATUS";
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            path = argv[++i];
+        } else if (arg == "--shutdown") {
+            line = "SHUTDOWN";
+        } else if (std::strtol(arg.c_str(), nullptr, 10) > 0) {
+            line = "STATUS " + arg;
+        } else {
+            std::fprintf(stderr, "usage: simulation --status [--socket PATH] [--shutdown] [JOB]\n");
+            return 2;
+        }
+    }
+    return request(path, line);
+}
+
+#else
+
+static int unsupported() {
+    std::fprintf(stderr, "The job server is not supported on this platform, it needs Unix sockets and fork()\n");
+    return 2;
+}
+
+int runJobServer(int, char *[]) {
+    return unsupported();
+}
+
+int runJobSubmit(int, char *[]) {
+    return unsupported();
+}
+
+int runJobStatus(int, char *[]) {
+    return unsupported();
+}
+
+#endif
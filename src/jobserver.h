@@ -0,0 +1,14 @@
+/**
+ * @file jobserver.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Local job server running headless simulations in worker processes and its client
+ */
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+int runJobServer(int argc, char *argv[]);
+int runJobSubmit(int argc, char *argv[]);
+int runJobStatus(int argc, char *argv[]);
+
+#endif // JOBSERVER_H
@@ -0,0 +1,231 @@
+/**
+ * @file lookahead.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Prediction of the path of a remote robot computed in slices within a time budget
+ * @details usage: simulation --lookahead [--at T0] [--ticks T] [--budget US] [--robot I] scene.txt
+ *
+ * Runs the scene T0 ticks and predicts the next T ticks of remote robot I driving forward
+ * (pressing Move if it stands), giving the prediction at most US microseconds per tick of
+ * the main run. The prediction is then compared with the full simulation.
+ */
+#include "lookahead.h"
+#include "scene.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+/**
+ * @brief Take the robots around the robot and start predicting its next ticks
+ * @details a robot farther than two travels over the horizon and the reach of the sensors
+ * (see World::sensingReach()) can not get in the way of the robot or of the robots around
+ * it in time, the snapshot skips it; only the positions of the robots are read to find those
+ * in reach. The obstacles are not copied, the snapshot borrows the grid of the live world (see
+ * World::borrowObstacles()); while the live world has not built it after a change of its obstacles,
+ * nothing is started and robot() stays null, start again after the next tick of the live world
+ */
+void LookAhead::start(const World& world, Handle robot, long ticks) {
+    cancel();
+    source = robot;
+    if (!world.contains(robot) || ticks <= 0) return;
+    RobotRecord record = world.robotRecord(robot);
+    if (record.kind != RobotKind::Remote) return;
+
+    double fastest = 0;
+    for (std::size_t block = 0; block < world.paramBlockCount(); ++block) {
+        fastest = std::max(fastest, 0.1 * std::abs(world.params(static_cast<std::uint32_t>(block)).speed));
+    }
+    double margin = 2 * fastest * ticks + world.sensingReach();
+    Box area{record.position.x - margin, record.position.y - margin, record.position.x + margin, record.position.y + margin};
+
+    snapshot = std::make_unique<World>();
+    snapshot->setBounds(world.bounds());
+    snapshot->setFixedPoint(world.fixedPoint());
+    snapshot->setSenseInterval(RobotKind::Autonomous, world.senseInterval(RobotKind::Autonomous));
+    snapshot->setSenseInterval(RobotKind::Remote, world.senseInterval(RobotKind::Remote));
+    snapshot->setKineticScheduling(world.kineticScheduling());
+    if (!snapshot->borrowObstacles(world)) {
+        cancel();
+        return;
+    }
+    // inserted in the order of the live world, which decides who moves first
+    auto copyRobots = [&](const auto& table) {
+        const std::vector<Position>& positions = table.template column<Position>();
+        for (std::size_t row = 0; row < positions.size(); ++row) {
+            if (!boxContains(area, positions[row].x, positions[row].y)) continue;
+            Handle handle = table.template get<Identity>(row).handle;
+            Handle copy = snapshot->insertRobot(world.robotRecord(handle));
+            if (handle == robot) {
+                target = copy;
+            }
+            ++copiedRobots;
+        }
+    };
+    copyRobots(world.autonomous);
+    copyRobots(world.remote);
+
+    horizon = ticks;
+    trajectory.push_back(record.position);
+    if (!record.control.isMoving) {
+        snapshot->moveForward(target);  // as if the operator pressed Move now
+        if (!snapshot->robotRecord(target).control.isMoving) {  // something is right in front of it
+            contact = true;
+            snapshot.reset();
+        }
+    }
+}
+
+/**
+ * @brief Continue the prediction until it finishes or the budget runs out
+ * @details the budget is checked after every tick of the snapshot, a call overruns it by less than one tick
+ *
+ * @return true when the prediction is finished
+ */
+bool LookAhead::advance(std::chrono::microseconds budget) {
+    auto begin = std::chrono::steady_clock::now();
+    while (snapshot) {
+        if (ticks() >= horizon) {
+            snapshot.reset();
+            break;
+        }
+        snapshot->step();
+        RobotRecord record = snapshot->robotRecord(target);
+        trajectory.push_back(record.position);
+        if (!record.control.isMoving) {  // stopped by its sensor, see StopOnContact
+            contact = true;
+            snapshot.reset();
+            break;
+        }
+        if (std::chrono::steady_clock::now() - begin >= budget) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Drop the prediction, e.g. after a command changed the course of the robot
+ */
+void LookAhead::cancel() {
+    snapshot.reset();
+    source = Handle{};
+    target = Handle{};
+    horizon = 0;
+    copiedRobots = 0;
+    trajectory.clear();
+    contact = false;
+}
+
+/**
+ * @brief Find the I-th remote robot of the world
+ */
+static Handle remoteRobot(const World& world, long index) {
+    Handle found;
+    world.forEachRobot([&](RobotKind kind, Handle handle, const Position&, const Heading&, const ParamBlock&) {
+        if (kind == RobotKind::Remote && index-- == 0) {
+            found = handle;
+        }
+    });
+    return found;
+}
+
+/**
+ * @brief Entry point of the headless look-ahead check
+ *
+ * @param argc number of arguments following --lookahead
+ * @param argv arguments following --lookahead
+ * @return int exit code
+ */
+int runLookAhead(int argc, char *argv[]) {
+    long at = 0, ticks = 300, budget = 1000, robotIndex = 0;
+    std::string file;
+    bool valid = true;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--at" || arg == "--ticks" || arg == "--budget" || arg == "--robot") && i + 1 < argc) {
+            long value = std::strtol(argv[++i], nullptr, 10);
+            if (arg == "--at") at = value;
+            else if (arg == "--ticks") ticks = value;
+            else if (arg == "--budget") budget = value;
+            else robotIndex = value;
+        } else if (!arg.empty() && arg[0] != '-' && file.empty()) {
+            file = arg;
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || file.empty() || at < 0 || ticks <= 0 || budget <= 0 || robotIndex < 0) {
+        std::fprintf(stderr, "usage: simulation --lookahead [--at T0] [--ticks T] [--budget US] [--robot I] scene.txt\n");
+        return 2;
+    }
+    Scene scene;
+    if (!loadScene(file, scene)) {
+        std::fprintf(stderr, "Cannot open file for reading: %s\n", file.c_str());
+        return 2;
+    }
+    World world;
+    populateWorld(world, scene);
+    for (long tick = 0; tick < at; ++tick) {
+        world.step();
+    }
+    Handle robot = remoteRobot(world, robotIndex);
+    if (robot.isNull()) {
+        std::fprintf(stderr, "The scene has no remote robot %ld at tick %ld\n", robotIndex, at);
+        return 2;
+    }
+
+    // the prediction gets its budget after every tick of the main run, as in the window
+    LookAhead lookAhead;
+    double longest = 0;
+    long frames = 0;
+    for (;;) {
+        auto begin = std::chrono::steady_clock::now();
+        lookAhead.start(world, robot, ticks);
+        longest = std::max(longest, std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+        if (lookAhead.robot() == robot) break;
+        world.step();  // builds the obstacle grid the prediction borrows
+        ++at;
+        ++frames;
+    }
+    for (bool done = lookAhead.finished(); !done; ++frames) {
+        world.step();
+        auto begin = std::chrono::steady_clock::now();
+        done = lookAhead.advance(std::chrono::microseconds(budget));
+        longest = std::max(longest, std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+    }
+    const std::vector<Position>& path = lookAhead.path();
+    std::printf("remote robot %ld (handle %u:%u) at (%.1f, %.1f) at tick %ld, %ld ticks ahead, snapshot of %zu robots\n",
+                robotIndex, robot.index, robot.generation, path.front().x, path.front().y, at, ticks, lookAhead.snapshotRobots());
+    std::printf("predicted over %ld frames, longest slice %.3f ms of a %.3f ms budget\n", frames, longest * 1e3, budget / 1e3);
+    std::printf("prediction: %s after %ld ticks at (%.1f, %.1f)\n", lookAhead.hasContact() ? "stopped by its sensor" : "still driving",
+                lookAhead.ticks(), path.back().x, path.back().y);
+
+    // the same ticks in the full world
+    World reference;
+    populateWorld(reference, scene);
+    for (long tick = 0; tick < at; ++tick) {
+        reference.step();
+    }
+    if (!reference.robotRecord(robot).control.isMoving) {
+        reference.moveForward(robot);
+    }
+    double deviation = 0;
+    long tick = 0;
+    bool stopped = !reference.robotRecord(robot).control.isMoving;
+    Position position = reference.robotRecord(robot).position;
+    while (!stopped && tick < ticks) {
+        reference.step();
+        ++tick;
+        RobotRecord record = reference.robotRecord(robot);
+        position = record.position;
+        stopped = !record.control.isMoving;
+        if (tick < static_cast<long>(path.size())) {
+            deviation = std::max(deviation, std::hypot(double(position.x) - path[tick].x, double(position.y) - path[tick].y));
+        }
+    }
+    std::printf("full simulation: %s after %ld ticks at (%.1f, %.1f), largest deviation %.2f px\n",
+                stopped ? "stopped by its sensor" : "still driving", tick, position.x, position.y, deviation);
+    return 0;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file lookahead.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Prediction of the path of a remote robot computed in slices within a time budget
+ */
+#ifndef LOOKAHEAD_H
+#define LOOKAHEAD_H
+
+#include "world.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/**
+ * @class LookAhead
+ * @brief Simulates the next ticks of a remote robot driving forward on a snapshot of its surroundings
+ * @details start() copies the robots which can reach the robot within the horizon into a
+ * small world of its own, which borrows the obstacle grid of the live world, advance() steps
+ * that world until the budget of the call runs out, so the prediction spreads over as many
+ * frames as it needs. Sources are not copied, robots they spawn meanwhile are not predicted.
+ */
+class LookAhead {
+public:
+    void start(const World& world, Handle robot, long ticks);
+    bool advance(std::chrono::microseconds budget);
+    void cancel();
+
+    Handle robot() const { return source; }
+    bool finished() const { return !snapshot; }
+    long ticks() const { return static_cast<long>(trajectory.size()) - 1; }
+    std::size_t snapshotRobots() const { return copiedRobots; }
+    /**
+     * @brief Positions of the robot from the start of the prediction, one per tick
+     */
+    const std::vector<Position>& path() const { return trajectory; }
+    /**
+     * @brief The sensor of the robot stops it at the end of the path
+     */
+    bool hasContact() const { return contact; }
+
+private:
+    std::unique_ptr<World> snapshot;  // dropped when the prediction is finished
+    Handle source;  // robot in the live world
+    Handle target;  // the same robot in the snapshot
+    long horizon = 0;
+    std::size_t copiedRobots = 0;
+    std::vector<Position> trajectory;
+    bool contact = false;
+};
+
+int runLookAhead(int argc, char *argv[]);
+
+#endif // LOOKAHEAD_H
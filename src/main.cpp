@@ -5,8 +5,19 @@
  * 
  */
 #include "mainwindow.h"
+#include "bench.h"
+#include "regress.h"
+#include "trace.h"
+#include "partition.h"
+#include "worldhost.h"
+#include "sweep.h"
+#include "ensemble.h"
+#include "jobserver.h"
+#include "whatif.h"
+#include "lookahead.h"
 
 #include <QApplication>
+#include <cstring>
 
 /**
  * @brief entry point of the application
@@ -17,6 +28,51 @@
  */
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {  // headless benchmark, no window
+        return runBenchmark(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--bench-trig") == 0) {  // heading math microbenchmark
+        return runTrigBenchmark(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--regress") == 0) {  // headless regression check
+        return runRegression(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--trace") == 0) {  // record state hashes of a headless run
+        return runTrace(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--trace-diff") == 0) {  // find where two recordings diverge
+        return runTraceDiff(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--partition") == 0) {  // the world split between processes
+        return runPartition(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--host") == 0) {  // many worlds in one process
+        return runHost(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--sweep") == 0) {  // parameter sweep of the autonomous robots
+        return runSweep(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--ensemble") == 0) {  // Monte Carlo runs of a perturbed scene
+        return runEnsemble(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--serve") == 0) {  // local job server
+        return runJobServer(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--submit") == 0) {  // queue a job on the job server
+        return runJobSubmit(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--status") == 0) {  // jobs of the job server
+        return runJobStatus(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--whatif") == 0) {  // what-if branches of a headless run
+        return runWhatIf(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--whatif-worker") == 0) {  // one what-if branch, see WhatIfBranch
+        return runWhatIfWorker(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--lookahead") == 0) {  // predicted path of a remote robot
+        return runLookAhead(argc - 2, argv + 2);
+    }
 
     QApplication a(argc, argv);
     MainWindow w;
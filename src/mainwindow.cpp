@@ -9,6 +9,7 @@
 #include "obstacle.h"
 #include "createobstacledialog.h"
 #include "createRobotDialog.h"
+#include "scene.h"
 #include "ui_mainwindow.h"
 #include <QGraphicsScene>
 #include <QDebug>
@@ -20,6 +21,15 @@
 #include <stdio.h>
 #include <QGraphicsDropShadowEffect>
 #include <QMessageBox>
+#include <QSocketNotifier>
+#include <QGraphicsPathItem>
+#include <QPainterPath>
+
+static constexpr long whatIfTicks = 300;  // how far a what-if branch looks ahead
+static constexpr int whatIfTurn = 45;  // degrees the selected robot turns in the branches
+static constexpr long lookAheadTicks = 300;  // 3 s of the selected robot are predicted
+static constexpr std::chrono::microseconds lookAheadBudget{2000};  // of the 10 ms between two ticks
+static constexpr int lookAheadRefresh = 20;  // ticks after which a finished prediction is started again
 
 /**
  * @brief constructor of the MainWindow class
@@ -52,6 +62,8 @@ MainWindow::MainWindow(QWidget *parent)
 
     connect(ui->clearButton, &QPushButton::clicked, this, &MainWindow::clearScene);
 
+    connect(ui->whatIfButton, &QPushButton::clicked, this, &MainWindow::branchWhatIf);
+
     ui->startButton->setStyleSheet("QPushButton { background-color: green; }");
     ui->stopButton->setStyleSheet("QPushButton { background-color: red; }");
 
@@ -59,15 +71,18 @@ MainWindow::MainWindow(QWidget *parent)
 
     // create scene
     QGraphicsScene *scene = new QGraphicsScene(this);
-    scene->setSceneRect(0, 0, 1500, 600);
+    const Box& bounds = world.bounds();
+    scene->setSceneRect(bounds.minX, bounds.minY, bounds.maxX - bounds.minX, bounds.maxY - bounds.minY);
     scene->setBackgroundBrush(QBrush(QColor(51,51,51,200)));
+    // robots off the screen sense less often, see visibleArea()
+    world.setFarSenseInterval(8);
 
     // create widget and link with scene
     ui->graphicsView->setScene(scene);
 
-    // turn of scrollbars
-    ui->graphicsView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    ui->graphicsView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    // scrollbars show up only for worlds larger than the view
+    ui->graphicsView->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    ui->graphicsView->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
     // ensure that the view stays centered on resize
     ui->graphicsView->setResizeAnchor(QGraphicsView::AnchorViewCenter);
     ui->graphicsView->setTransform(QTransform());
@@ -88,16 +103,17 @@ MainWindow::MainWindow(QWidget *parent)
  * 
  */
 MainWindow::~MainWindow()
-{}
+{
+    clearWhatIf();  // kills the branches still running
+}
 
 /**
  * @brief Starts or continues the simulation
  *
  */
 void MainWindow::startSimulation() {
-    if (!timer->isActive()) {
-        timer->start();
-    }
+    running = true;
+    resumeTimer();
 }
 
 /**
@@ -105,11 +121,22 @@ void MainWindow::startSimulation() {
  *
  */
 void MainWindow::stopSimulation() {
+    running = false;
     if (timer->isActive()) {
         timer->stop();
     }
 }
 
+/**
+ * @brief Restart the timer paused while the world was idle
+ * @details called after every change of the world, the next tick runs it
+ */
+void MainWindow::resumeTimer() {
+    if (running && !timer->isActive()) {
+        timer->start();
+    }
+}
+
 /**
  * @brief Import test file
  *
@@ -128,7 +155,7 @@ void MainWindow::onLoadFileClicked() {
  */
 void MainWindow::createObstacle()
 {
-    CreateObstacleDialog dialog(this);
+    CreateObstacleDialog dialog(ui->graphicsView->sceneRect(), this);
     if (dialog.exec() == QDialog::Accepted) {
         int x = dialog.getX();
         int y = dialog.getY();
@@ -139,16 +166,16 @@ void MainWindow::createObstacle()
 
         // Check for overlap with other objects
         QList<QGraphicsItem *> foundItems = ui->graphicsView->scene()->items(creationObstacleArea);
-        if (!foundItems.isEmpty()) {
-            bool obstacleFound = false;
-            bool robotFound = false;
-            for (QGraphicsItem *item : foundItems) {
-                if (dynamic_cast<Robot*>(item)) {
-                    robotFound = true;
-                } else if (dynamic_cast<Obstacle*>(item)) {
-                    obstacleFound = true;
-                }
+        bool obstacleFound = false;
+        bool robotFound = false;
+        for (QGraphicsItem *item : foundItems) {  // source and sink markers do not block placement
+            if (dynamic_cast<Robot*>(item)) {
+                robotFound = true;
+            } else if (dynamic_cast<Obstacle*>(item)) {
+                obstacleFound = true;
             }
+        }
+        if (robotFound || obstacleFound) {
 
             QString message = "Cannot place an obstacle here. The space is already occupied by ";
             if (robotFound && obstacleFound) {
@@ -163,8 +190,10 @@ void MainWindow::createObstacle()
             return;
         }
 
-        Obstacle *obstacle = new Obstacle(x, y, width);
+        Handle handle = world.addObstacle(x, y, width);
+        Obstacle *obstacle = new Obstacle(x, y, width, handle);
         ui->graphicsView->scene()->addItem(obstacle);
+        resumeTimer();
     }
 }
 
@@ -200,7 +229,7 @@ void MainWindow::deleteObstacle()
  * @details create robot dialog where user can set robot type, position, orientation, speed and detection radius
  */
 void MainWindow::createRobot() {
-    CreateRobotDialog dialog(this);
+    CreateRobotDialog dialog(ui->graphicsView->sceneRect(), this);
     if (dialog.exec() == QDialog::Accepted) {
         int robotType = dialog.getRobotType();
         int orientation = dialog.getOrientation();
@@ -214,16 +243,16 @@ void MainWindow::createRobot() {
 
         // Overlap check
         QList<QGraphicsItem *> foundItems = ui->graphicsView->scene()->items(creationArea);
-        if (!foundItems.isEmpty()) {
-            bool obstacleFound = false;
-            bool robotFound = false;
-            for (QGraphicsItem *item : foundItems) {
-                if (dynamic_cast<Robot*>(item)) {
-                    robotFound = true;
-                } else if (dynamic_cast<Obstacle*>(item)) {
-                    obstacleFound = true;
-                }
+        bool obstacleFound = false;
+        bool robotFound = false;
+        for (QGraphicsItem *item : foundItems) {  // source and sink markers do not block placement
+            if (dynamic_cast<Robot*>(item)) {
+                robotFound = true;
+            } else if (dynamic_cast<Obstacle*>(item)) {
+                obstacleFound = true;
             }
+        }
+        if (robotFound || obstacleFound) {
 
             QString message = "Cannot place a robot here. The space is already occupied by ";
             if (robotFound && obstacleFound) {
@@ -238,18 +267,21 @@ void MainWindow::createRobot() {
             return;
         }
 
+        RobotKind kind = robotType == 0 ? RobotKind::Autonomous : RobotKind::Remote;
+        Handle handle;
         if (robotType == 0) {  // Autonomous
             double avoidanceAngle = dialog.getAvoidanceAngle();
-            AutonomousRobot *robotItem = new AutonomousRobot(x, y, orientation, detectionRadius, avoidanceAngle, speed);
-            autonomousRobots.append(robotItem);
-            ui->graphicsView->scene()->addItem(robotItem);
-            ui->graphicsView->scene()->update();
+            handle = world.addAutonomousRobot(x, y, orientation, detectionRadius, avoidanceAngle, speed);
         } else {  // Remote Controlled
-            RemoteRobot *remoteRobotItem = new RemoteRobot(x, y, speed, detectionRadius);
-            remoteRobots.append(remoteRobotItem);
-            ui->graphicsView->scene()->addItem(remoteRobotItem);
-            ui->graphicsView->scene()->update();
+            handle = world.addRemoteRobot(x, y, speed, detectionRadius);
+        }
+        if (handle.isNull()) {
+            QMessageBox::warning(this, tr("Error"), tr("Cannot create the robot. The world holds as many robots as it can."));
+            return;
         }
+        addRobotItem(kind, handle);
+        syncRobots();
+        ui->graphicsView->scene()->update();
     }
 }
 
@@ -272,10 +304,86 @@ void MainWindow::deleteRobot()
 /**
  * @brief select remote controlled robot
  *
- * @param robot pointer to remote controlled robot
+ * @param robot handle of remote controlled robot, null handle to clear the selection
  */
-void MainWindow::selectRobot(RemoteRobot* robot) {
+void MainWindow::selectRobot(Handle robot) {
     selectedRobot = robot;  // save selected robot
+    lookAhead.cancel();
+    drawLookAhead();  // the path of the previous robot is gone, the next tick predicts the new one
+}
+
+/**
+ * @brief Part of the world shown in the view with a margin, robots in it are simulated in full detail
+ */
+Box MainWindow::visibleArea() const {
+    const qreal margin = 200;  // robots entering the view have checked their field of vision meanwhile
+    QRectF visible = ui->graphicsView->mapToScene(ui->graphicsView->viewport()->rect()).boundingRect();
+    return Box{visible.left() - margin, visible.top() - margin, visible.right() + margin, visible.bottom() + margin};
+}
+
+/**
+ * @brief Find view of the robot
+ *
+ * @param robot handle of the robot
+ * @return view or nullptr if the handle does not refer to a live robot
+ */
+Robot* MainWindow::robotItem(Handle robot) const {
+    return robotItems.value(robot.key(), nullptr);
+}
+
+/**
+ * @brief Create view for the robot stored in the engine and add it to the scene
+ * @details the view is positioned by the next syncRobots()
+ *
+ * @param kind kind of the robot
+ * @param handle handle of the robot in the engine
+ */
+void MainWindow::addRobotItem(RobotKind kind, Handle handle) {
+    Robot *robotItem = new Robot(kind, handle);
+    robotItems.insert(handle.key(), robotItem);
+    ui->graphicsView->scene()->addItem(robotItem);
+    resumeTimer();
+}
+
+/**
+ * @brief Remove robot from the engine and delete its view
+ *
+ * @param robot view of the robot
+ */
+void MainWindow::removeRobot(Robot* robot) {
+    if (selectedRobot == robot->handle()) {
+        selectRobot(Handle{});  // Clear the selected robot if it is the one being deleted
+    }
+    world.removeRobot(robot->handle());
+    robotItems.remove(robot->handle().key());
+    ui->graphicsView->scene()->removeItem(robot);
+    delete robot;
+    ui->graphicsView->scene()->update();
+    resumeTimer();
+}
+
+/**
+ * @brief Remove obstacle from the engine and delete its view
+ *
+ * @param obstacle view of the obstacle
+ */
+void MainWindow::removeObstacle(Obstacle* obstacle) {
+    world.removeObstacle(obstacle->handle());
+    ui->graphicsView->scene()->removeItem(obstacle);
+    delete obstacle;
+    resumeTimer();
+}
+
+/**
+ * @brief Copy the engine state to the robot views
+ */
+void MainWindow::syncRobots() {
+    world.forEachRobot([this](RobotKind, Handle handle, const Position& position, const Heading& heading, const ParamBlock& params) {
+        Robot *item = robotItem(handle);
+        if (item) {
+            item->sync(position, heading, params);
+        }
+    });
 }
 
 /**
@@ -283,8 +391,11 @@ void MainWindow::selectRobot(RemoteRobot* robot) {
  *
  */
 void MainWindow::moveRobot() {
-    if (selectedRobot && selectedRobot->scene() && timer->isActive()) {  // Check if selectedRobot is still in the scene
-        selectedRobot->moveForward();
+    if (world.contains(selectedRobot) && running) {  // Check if selectedRobot is still alive
+        world.moveForward(selectedRobot);
+        lookAhead.cancel();  // the course changed, predict again
+        syncRobots();
+        resumeTimer();
     }
 }
 
@@ -293,8 +404,11 @@ void MainWindow::moveRobot() {
  *
  */
 void MainWindow::rotateRobotRight() {
-    if (selectedRobot && timer->isActive()) {
-        selectedRobot->rotateRight();
+    if (world.contains(selectedRobot) && running) {
+        world.rotateRight(selectedRobot);
+        lookAhead.cancel();  // the course changed, predict again
+        syncRobots();
+        resumeTimer();
     }
 }
 
@@ -303,8 +417,11 @@ void MainWindow::rotateRobotRight() {
  *
  */
 void MainWindow::rotateRobotLeft() {
-    if (selectedRobot && timer->isActive()) {
-        selectedRobot->rotateLeft();
+    if (world.contains(selectedRobot) && running) {
+        world.rotateLeft(selectedRobot);
+        lookAhead.cancel();  // the course changed, predict again
+        syncRobots();
+        resumeTimer();
     }
 }
 
@@ -313,45 +430,243 @@ void MainWindow::rotateRobotLeft() {
  *
  */
 void MainWindow::stopRobot() {
-    if (selectedRobot) {
-        selectedRobot->stop();
-    }
+    world.stop(selectedRobot);  // stale or null handles are ignored
+    lookAhead.cancel();
 }
 
 /**
  * @brief Update robots positions
- * Updates all robots in the scene
+ * Advances the engine by one tick and refreshes all robot views
  */
 void MainWindow::updateRobots() {
     ui->graphicsView->scene()->update();
-    for (Robot* robot : autonomousRobots) {  // go through all autonomous robots
-        robot->update();
-    }
-    for (Robot* robot: remoteRobots) { // go through all remote controlled robots
-        RemoteRobot* remoteRobot = dynamic_cast<RemoteRobot*>(robot);
-        if (remoteRobot->getRotationDirection() == RemoteRobot::RotateRight) {
-            rotateRobotRight();
-        } else if (remoteRobot->getRotationDirection() == RemoteRobot::RotateLeft) {
-            rotateRobotLeft();
+    world.setFocus(visibleArea(), selectedRobot);
+    world.step();
+
+    // robots removed by sinks and spawned by sources
+    for (Handle handle : world.despawned()) {
+        Robot *item = robotItem(handle);
+        if (item) {
+            removeRobot(item);
         }
-        if(remoteRobot->isMoving){
-            remoteRobot->update();
+    }
+    for (Handle handle : world.spawned()) {
+        addRobotItem(RobotKind::Autonomous, handle);
+    }
+    syncRobots();
+    updateLookAhead();
+    if (world.isIdle()) {
+        timer->stop();  // nothing changes until the next command, see resumeTimer()
+    }
+}
+
+/**
+ * @brief Give the prediction of the selected robot its slice of the tick
+ * @details the prediction runs on a snapshot of the surroundings of the robot, so it may
+ * take several ticks; it is started again when a command changes the course of the robot
+ * or lookAheadRefresh ticks after it finished, as the other robots moved on meanwhile
+ */
+void MainWindow::updateLookAhead() {
+    if (!world.contains(selectedRobot)) {
+        if (!lookAheadItems.isEmpty()) {
+            lookAhead.cancel();
+            drawLookAhead();
         }
+        return;
+    }
+    if (lookAhead.robot() != selectedRobot || (lookAhead.finished() && ++lookAheadAge >= lookAheadRefresh)) {
+        lookAhead.start(world, selectedRobot, lookAheadTicks);
+        lookAheadAge = 0;
+        if (lookAhead.finished() && lookAhead.robot() == selectedRobot) {
+            drawLookAhead();  // it can not move at all
+        }
+    }
+    if (!lookAhead.finished() && lookAhead.advance(lookAheadBudget)) {
+        drawLookAhead();
     }
 }
 
+/**
+ * @brief Draw the predicted path of the selected robot and where its sensor will stop it
+ * @details the previous prediction stays drawn until the next one finishes
+ */
+void MainWindow::drawLookAhead() {
+    for (QGraphicsItem *item : lookAheadItems) {
+        ui->graphicsView->scene()->removeItem(item);
+        delete item;
+    }
+    lookAheadItems.clear();
+    const std::vector<Position>& path = lookAhead.path();
+    if (path.empty()) return;
+
+    QPainterPath line(QPointF(path.front().x, path.front().y));
+    for (const Position& point : path) {
+        line.lineTo(point.x, point.y);
+    }
+    QGraphicsPathItem *pathItem = ui->graphicsView->scene()->addPath(line, QPen(Qt::yellow, 1, Qt::DotLine));
+    lookAheadItems.append(pathItem);
+    if (lookAhead.hasContact()) {
+        const Position& stop = path.back();
+        lookAheadItems.append(ui->graphicsView->scene()->addEllipse(stop.x - robotRadius, stop.y - robotRadius,
+                                                                    2 * robotRadius, 2 * robotRadius, QPen(Qt::red, 2, Qt::DashLine)));
+    }
+    for (QGraphicsItem *item : lookAheadItems) {
+        item->setAcceptedMouseButtons(Qt::NoButton);
+        item->setZValue(-0.5);  // above the markers, below the robots
+    }
+}
+
+/**
+ * @brief Predict what happens if the selected robot turns left or right now
+ * @details branches the world three times: unchanged and with the selected robot turned by
+ * whatIfTurn degrees to either side and driving forward. The branches run ahead on copies
+ * of the world in worker processes while the simulation goes on, their trajectories are
+ * drawn when they finish, see drawBranches()
+ */
+void MainWindow::branchWhatIf() {
+    if (!world.contains(selectedRobot)) return;
+    clearWhatIf();
+    auto image = std::make_shared<std::vector<char>>();
+    world.writeImage(*image);  // once for all the branches
+    const WhatIf changes[] = {
+        WhatIf{Handle{}, 0, false, whatIfTicks},
+        WhatIf{selectedRobot, -whatIfTurn, true, whatIfTicks},
+        WhatIf{selectedRobot, whatIfTurn, true, whatIfTicks},
+    };
+    for (const WhatIf& change : changes) {
+        auto branch = std::make_unique<WhatIfBranch>();
+        if (!branch->start(image, change)) {
+            qDebug() << "Cannot start a what-if branch";
+            clearWhatIf();
+            return;
+        }
+        int index = static_cast<int>(branches.size());
+        QSocketNotifier *notifier = new QSocketNotifier(branch->fd(), QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, [this, index]() { readBranch(index); });
+        QSocketNotifier *sender = nullptr;
+        if (branch->sending()) {  // the rest of the image goes out whenever the worker has read some
+            sender = new QSocketNotifier(branch->fd(), QSocketNotifier::Write, this);
+            connect(sender, &QSocketNotifier::activated, this, [this, index]() { sendBranch(index); });
+        }
+        branches.push_back(std::move(branch));
+        branchNotifiers.append(notifier);
+        sendNotifiers.append(sender);
+    }
+}
+
+/**
+ * @brief Send the worker of a branch the next part of the world image
+ *
+ * @param branch index of the branch
+ */
+void MainWindow::sendBranch(int branch) {
+    QSocketNotifier *notifier = sendNotifiers.value(branch, nullptr);
+    if (!notifier || branches[branch]->write()) return;
+    notifier->setEnabled(false);
+    notifier->deleteLater();
+    sendNotifiers[branch] = nullptr;
+}
+
+/**
+ * @brief Take the trajectories a branch has sent so far
+ *
+ * @param branch index of the branch
+ */
+void MainWindow::readBranch(int branch) {
+    QSocketNotifier *notifier = branchNotifiers.value(branch, nullptr);
+    if (!notifier) return;
+    notifier->setEnabled(false);  // the branch closes its socket when it finishes
+    if (branches[branch]->read()) {
+        notifier->setEnabled(true);
+        return;
+    }
+    notifier->deleteLater();
+    branchNotifiers[branch] = nullptr;
+    if (QSocketNotifier *sender = sendNotifiers.value(branch, nullptr)) {  // the worker is gone
+        sender->setEnabled(false);
+        sender->deleteLater();
+        sendNotifiers[branch] = nullptr;
+    }
+    if (branches[branch]->failed()) {
+        qDebug() << "A what-if worker failed";
+    }
+    drawBranches();
+}
+
+/**
+ * @brief Draw the path of the selected robot in every finished branch and the robots it affects
+ * @details a robot is affected if its path in a turned branch leaves its path in the unchanged
+ * one, such paths are drawn dashed in the color of the branch
+ */
+void MainWindow::drawBranches() {
+    for (QGraphicsItem *item : whatIfItems) {
+        ui->graphicsView->scene()->removeItem(item);
+        delete item;
+    }
+    whatIfItems.clear();
+
+    const QColor colors[] = {QColor(255, 255, 255), QColor(255, 165, 0), QColor(255, 0, 255)};
+    auto draw = [this](const Trajectory& trajectory, const QPen& pen) {
+        if (trajectory.points.empty()) return;
+        QPainterPath path(QPointF(trajectory.points.front().x, trajectory.points.front().y));
+        for (const Position& point : trajectory.points) {
+            path.lineTo(point.x, point.y);
+        }
+        QGraphicsPathItem *item = ui->graphicsView->scene()->addPath(path, pen);
+        item->setAcceptedMouseButtons(Qt::NoButton);
+        item->setZValue(-0.5);  // above the markers, below the robots
+        whatIfItems.append(item);
+    };
+    for (std::size_t i = 0; i < branches.size(); ++i) {
+        const WhatIfBranch& branch = *branches[i];
+        if (!branch.finished()) continue;
+        if (i > 0 && branches[0]->finished()) {
+            for (const Divergence& divergence : compareBranches(*branches[0], branch)) {
+                const Trajectory *trajectory = branch.trajectory(divergence.handle);
+                if (trajectory && divergence.handle != selectedRobot) {
+                    draw(*trajectory, QPen(colors[i], 1, Qt::DashLine));
+                }
+            }
+        }
+        const Trajectory *selected = branch.trajectory(selectedRobot);
+        if (selected) {
+            draw(*selected, QPen(colors[i], 2));
+        }
+    }
+}
+
+/**
+ * @brief Stop the what-if branches and remove their trajectories
+ */
+void MainWindow::clearWhatIf() {
+    for (QSocketNotifier *notifier : branchNotifiers + sendNotifiers) {
+        delete notifier;  // before the branch closes the descriptor it watches
+    }
+    branchNotifiers.clear();
+    sendNotifiers.clear();
+    branches.clear();
+    for (QGraphicsItem *item : whatIfItems) {
+        ui->graphicsView->scene()->removeItem(item);
+        delete item;
+    }
+    whatIfItems.clear();
+}
+
 /**
  * @brief Clear scene
  * @details Clear scene from all objects
  * 
  */
 void MainWindow::clearScene() {
+    clearWhatIf();
+    lookAheadItems.clear();  // deleted with the scene below
     ui->graphicsView->scene()->clear(); // delete all objects from scene
 
-    autonomousRobots.clear();
-    remoteRobots.clear();
+    world.clear();
+    robotItems.clear();
 
-    this->selectedRobot = nullptr;
+    this->selectedRobot = Handle{};
+    lookAhead.cancel();
 
     ui->graphicsView->scene()->update();
     qDebug() << "Scene cleared";
@@ -364,104 +679,66 @@ void MainWindow::clearScene() {
  * @param filename
  */
 void MainWindow::loadSceneFromFile(const QString& filename) {
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    Scene scene;
+    if (!loadScene(filename.toStdString(), scene)) {
         qDebug() << "Cannot open file for reading:" << filename;
         return;
     }
 
-    QTextStream in(&file);
-    QString buffer;
-    QString currentType;
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        if (line.isEmpty() || line.startsWith("#")) {
-            continue; // skip blanks and comments
-        }
-
-        if (line.endsWith("{")) {
-            // new object
-            currentType = line.left(line.length() - 1).trimmed();
-            buffer.clear();
-        } else if (line.startsWith("}")) {
-            // end of object
-            if (!currentType.isEmpty()) {
-                processObject(currentType, buffer);
-                currentType.clear();
-            }
-        } else {
-            buffer += line + "\n";
-        }
+    world.setBounds(declaredBounds(scene, world.bounds()));
+    const Box& bounds = world.bounds();
+    ui->graphicsView->scene()->setSceneRect(bounds.minX, bounds.minY, bounds.maxX - bounds.minX, bounds.maxY - bounds.minY);
+    for (const SceneObject* object : spatialOrder(scene, world.bounds())) {
+        processObject(*object);
     }
+    syncRobots();
+    ui->graphicsView->scene()->update();
+    resumeTimer();
 }
 
 /**
  * @brief Process object
- * @details Process object passed from file based on the type and attributes
- * @param type
- * @param attributes 
- */
-void MainWindow::processObject(const QString& type, const QString& attributes) {
-    QMap<QString, QString> params = parseAttributes(attributes);
-    qDebug() << "params: " << params;
-    int x = params.value("positionX").toInt();
-    qDebug() << "X: " << x;
-    int y = params.value("positionY").toInt();
-    int speed = params.value("speed").toInt();
-    int orientation = params.value("orientation").toInt();
-    double detectionRadius = params.value("detectionRadius").toDouble();
-    double avoidanceAngle = params.value("avoidanceAngle").toDouble();
-    int size = params.value("width").toInt();
-
-    if (type == "AutonomousRobot") {
-        AutonomousRobot *robotItem = new AutonomousRobot(x, y, orientation, detectionRadius, avoidanceAngle, speed);
-        autonomousRobots.append(robotItem);
-        ui->graphicsView->scene()->addItem(robotItem);
-        ui->graphicsView->scene()->update();
-    } else if (type == "RemoteRobot") {
-        RemoteRobot *remoteRobotItem = new RemoteRobot(x, y, speed, detectionRadius);
-        remoteRobots.append(remoteRobotItem);
-        ui->graphicsView->scene()->addItem(remoteRobotItem);
-        ui->graphicsView->scene()->update();
-    } else if (type == "Obstacle"){
-        Obstacle *obstacle = new Obstacle(x, y, size);
-        ui->graphicsView->scene()->addItem(obstacle);
+ * @details Create the engine entity for object passed from file and its view
+ * @param object
+ */
+void MainWindow::processObject(const SceneObject& object) {
+    Handle handle = addSceneObject(world, object);
+    if (object.type == "World" || object.type == "RobotTemplate") {
+        return;  // settings and shared parameters only, nothing to show
     }
-    else {
-        qDebug() << "Unknown object type:" << type;
+    if (object.type == "Source" || object.type == "Sink") {
+        addMarkerItem(object);
+        return;
     }
-}
-
-/**
- * @brief Parse attributes
- * @details Parse attributes from the file
- * @param attributes 
- * @return QMap<QString, QString> 
- */
-QMap<QString, QString> MainWindow::parseAttributes(const QString& attributes) {
-    QMap<QString, QString> params;
-    QStringList rawLines = attributes.split("\n");
-    QStringList lines;
-
-    // Manually remove empty lines
-    for (const QString& line : rawLines) {
-        if (!line.trimmed().isEmpty()) {
-            lines.append(line);
-        }
+    if (handle.isNull()) {
+        qDebug() << "Unknown object type:" << QString::fromStdString(object.type);
+        return;
     }
 
-    // Parse key-value pairs
-    for (const QString& line : lines) {
-        QStringList parts = line.split("=");
-        if (parts.size() == 2) {
-            QString key = parts[0].trimmed();
-            QString value = parts[1].trimmed();
-            params[key] = value;
-        }
+    if (object.type == "AutonomousRobot") {
+        addRobotItem(RobotKind::Autonomous, handle);
+    } else if (object.type == "RemoteRobot") {
+        addRobotItem(RobotKind::Remote, handle);
+    } else if (object.type == "Obstacle") {
+        int size = object.intValue("width");
+        Obstacle *obstacle = new Obstacle(object.intValue("positionX"), object.intValue("positionY"), size, handle);
+        ui->graphicsView->scene()->addItem(obstacle);
     }
-    return params;
 }
 
-
-
-
+/**
+ * @brief Draw the area of a source or a sink
+ * @details markers are only decoration, they do not take mouse clicks and robots drive through them
+ * @param object
+ */
+void MainWindow::addMarkerItem(const SceneObject& object) {
+    bool isSource = object.type == "Source";
+    qreal size = isSource ? 40 : object.intValue("width");
+    qreal x = object.intValue("positionX") - size / 2;
+    qreal y = object.intValue("positionY") - size / 2;
+
+    QGraphicsRectItem *marker = ui->graphicsView->scene()->addRect(x, y, size, size,
+        QPen(isSource ? Qt::green : Qt::cyan, 2, Qt::DashLine));
+    marker->setAcceptedMouseButtons(Qt::NoButton);
+    marker->setZValue(-1);  // keep robots above the markers
+}
@@ -10,7 +10,18 @@
 
 #include <QMainWindow>
 #include <QPointer>
+#include <QHash>
 #include "robots.h"
+#include "world.h"
+#include "whatif.h"
+#include "lookahead.h"
+#include <memory>
+#include <vector>
+
+class Obstacle;
+class QSocketNotifier;
+class QGraphicsItem;
+struct SceneObject;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -30,10 +41,13 @@ public:
     bool isDeletingModeActive() const { return deletingMode; }
     bool isRobotDeletingModeActive() const { return rDeletingMode; }
     ~MainWindow();
-    void selectRobot(RemoteRobot* robot);
-    QList<Robot*> autonomousRobots;
-    QList<Robot*> remoteRobots;
-    RemoteRobot* selectedRobot = nullptr;
+    void selectRobot(Handle robot);
+    void removeRobot(Robot* robot);
+    void removeObstacle(Obstacle* obstacle);
+    Robot* robotItem(Handle robot) const;
+    World world;
+    QHash<quint64, Robot*> robotItems;  // views of the engine robots by handle key
+    Handle selectedRobot;  // null handle when nothing is selected
     void loadSceneFromFile(const QString& filename);
 
 private slots: // slots are functions that are called when a signal is emitted
@@ -50,11 +64,30 @@ private slots: // slots are functions that are called when a signal is emitted
     void stopSimulation();
     void onLoadFileClicked();
     void clearScene();
-    void processObject(const QString& type, const QString& attributes);
-        QMap<QString, QString> parseAttributes(const QString& attributes);
+    void branchWhatIf();
 
 private:
     Ui::MainWindow *ui;
+    void addRobotItem(RobotKind kind, Handle handle);
+    void processObject(const SceneObject& object);
+    void addMarkerItem(const SceneObject& object);
+    void syncRobots();
+    void resumeTimer();
+    Box visibleArea() const;
+    void sendBranch(int branch);
+    void readBranch(int branch);
+    void drawBranches();
+    void clearWhatIf();
+    std::vector<std::unique_ptr<WhatIfBranch>> branches;  // unchanged world, selected robot turned left and right
+    QList<QSocketNotifier*> branchNotifiers;  // nullptr once the branch has finished
+    QList<QSocketNotifier*> sendNotifiers;  // nullptr once the image of the branch is sent
+    QList<QGraphicsItem*> whatIfItems;  // predicted trajectories drawn over the scene
+    void updateLookAhead();
+    void drawLookAhead();
+    LookAhead lookAhead;  // path of the selected robot, predicted a slice per tick
+    QList<QGraphicsItem*> lookAheadItems;
+    int lookAheadAge = 0;  // ticks since the prediction finished
+    bool running = false;  // started by the user, the timer pauses while the world is idle
     bool deletingMode;
     bool rDeletingMode;
 };
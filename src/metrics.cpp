@@ -0,0 +1,92 @@
+/**
+ * @file metrics.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Quality metrics of a headless run: stuck time, coverage and collisions
+ */
+#include "metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+static constexpr double coverageCell = 50;  // px
+static constexpr long stuckWindow = 50;  // ticks over which the progress of a robot is measured
+static constexpr double stuckProgress = 0.25;  // share of its possible travel a robot must make in the window
+
+MetricsProbe::MetricsProbe(const World& world) {
+    const Box& bounds = world.bounds();
+    columns = std::max(1, int(std::ceil((bounds.maxX - bounds.minX) / coverageCell)));
+    rows = std::max(1, int(std::ceil((bounds.maxY - bounds.minY) / coverageCell)));
+    visited.assign(std::size_t(columns) * rows, false);
+    for (const ObstacleShape& shape : world.obstacles.column<ObstacleShape>()) {
+        obstacles.push_back(shape);
+        widestObstacle = std::max(widestObstacle, double(shape.halfWidth));
+    }
+    std::sort(obstacles.begin(), obstacles.end(), [](const ObstacleShape& a, const ObstacleShape& b) { return a.x < b.x; });
+}
+
+/**
+ * @brief Account the state of the world after a tick
+ */
+void MetricsProbe::sample(const World& world, RunMetrics& metrics) {
+    const Box& bounds = world.bounds();
+    ++tick;
+    centers.clear();
+    world.forEachRobot([&](RobotKind kind, Handle handle, const Position& position, const Heading&, const ParamBlock& params) {
+        centers.push_back(position);
+        if (kind != RobotKind::Autonomous) return;
+        metrics.robotTicks += 1;
+        if (handle.index >= robots.size()) {
+            robots.resize(handle.index + 1);
+        }
+        Track& track = robots[handle.index];
+        if (track.handle != handle) {
+            track = Track{handle, position, tick, 0};
+        } else if (tick - track.since >= stuckWindow) {
+            // robots standing still on purpose (speed 0) are not stuck
+            double travel = stuckWindow * 0.1 * std::abs(params.speed);
+            double moved = std::hypot(position.x - track.anchor.x, position.y - track.anchor.y);
+            bool stuck = travel > 0 && moved < stuckProgress * travel;
+            track.stuckFor = stuck ? track.stuckFor + stuckWindow : 0;
+            metrics.stuckTicks += stuck ? stuckWindow : 0;
+            metrics.longestStuck = std::max(metrics.longestStuck, track.stuckFor);
+            track.anchor = position;
+            track.since = tick;
+        }
+
+        int column = std::min(columns - 1, std::max(0, int((position.x - bounds.minX) / coverageCell)));
+        int line = std::min(rows - 1, std::max(0, int((position.y - bounds.minY) / coverageCell)));
+        if (!visited[std::size_t(line) * columns + column]) {
+            visited[std::size_t(line) * columns + column] = true;
+            ++metrics.visitedCells;
+        }
+    });
+    metrics.collisions += countCollisions();
+    metrics.cells = visited.size();
+}
+
+/**
+ * @brief Robots whose bodies overlap another robot or an obstacle, touching does not count
+ * @details sweep along x over the robots and the obstacles both sorted by x; a robot is counted
+ * once however many bodies it overlaps, so a pile of robots counts its robots and not its pairs
+ */
+std::uint64_t MetricsProbe::countCollisions() {
+    std::sort(centers.begin(), centers.end(), [](const Position& a, const Position& b) { return a.x < b.x; });
+    colliding.assign(centers.size(), false);
+    for (std::size_t i = 0; i < centers.size(); ++i) {
+        for (std::size_t j = i + 1; j < centers.size() && centers[j].x - centers[i].x < 2 * robotRadius; ++j) {
+            if (std::fabs(centers[j].y - centers[i].y) < 2 * robotRadius) {
+                colliding[i] = true;
+                colliding[j] = true;
+            }
+        }
+        double reach = robotRadius + widestObstacle;
+        auto first = std::lower_bound(obstacles.begin(), obstacles.end(), centers[i].x - reach,
+                                      [](const ObstacleShape& shape, double x) { return shape.x < x; });
+        for (auto it = first; !colliding[i] && it != obstacles.end() && it->x < centers[i].x + reach; ++it) {
+            double limit = robotRadius + it->halfWidth;
+            colliding[i] = std::fabs(it->x - centers[i].x) < limit && std::fabs(it->y - centers[i].y) < limit;
+        }
+    }
+    return static_cast<std::uint64_t>(std::count(colliding.begin(), colliding.end(), true));
+}
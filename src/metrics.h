@@ -0,0 +1,63 @@
+/**
+ * @file metrics.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Quality metrics of a headless run: stuck time, coverage and collisions
+ */
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <cstdint>
+#include <vector>
+#include "world.h"
+
+/**
+ * @brief Metrics accumulated over the ticks of one run
+ */
+struct RunMetrics {
+    double robotTicks = 0;  // autonomous robots summed over the ticks
+    double stuckTicks = 0;
+    long longestStuck = 0;  // most ticks one robot was stuck in a row
+    std::size_t visitedCells = 0;
+    std::size_t cells = 0;
+    std::uint64_t collisions = 0;  // robots overlapping another robot or an obstacle, each once per tick, summed over the ticks
+
+    double stuckPercent() const { return robotTicks > 0 ? 100 * stuckTicks / robotTicks : 0; }
+    double coveragePercent() const { return cells > 0 ? 100.0 * visitedCells / cells : 0; }
+};
+
+/**
+ * @class MetricsProbe
+ * @brief Collects the metrics of one world tick by tick
+ * @details a robot is stuck for a window of 50 ticks when it got less than a quarter of its
+ * possible travel away from where it started the window, e.g. when it keeps turning in a corner.
+ * Coverage is the share of the 50x50 px cells of the world visited by an autonomous robot.
+ * The obstacles are taken once, they must not change during the run
+ */
+class MetricsProbe {
+public:
+    explicit MetricsProbe(const World& world);
+
+    void sample(const World& world, RunMetrics& metrics);
+
+private:
+    struct Track {
+        Handle handle;
+        Position anchor;  // position at the start of the current window
+        long since;  // tick the window started
+        long stuckFor;  // ticks stuck in a row
+    };
+
+    std::vector<Track> robots;  // per handle index
+    std::vector<bool> visited;  // coverage cells
+    int columns = 1, rows = 1;
+    std::vector<ObstacleShape> obstacles;  // sorted by x
+    double widestObstacle = 0;
+    std::vector<Position> centers;  // robots of the current tick
+    std::vector<bool> colliding;  // per center, counted once however many bodies it overlaps
+    long tick = 0;
+
+    std::uint64_t countCollisions();
+};
+
+#endif // METRICS_H
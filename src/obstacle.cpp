@@ -11,6 +11,26 @@
 #include "qpen.h"
 #include <QGraphicsSceneMouseEvent>
 #include "mainwindow.h"
+#include "arena.h"
+
+static BlockPool& obstaclePool() {
+    static BlockPool pool(sizeof(Obstacle));
+    return pool;
+}
+
+void* Obstacle::operator new(std::size_t size) {
+    if (size != sizeof(Obstacle)) return ::operator new(size);  // derived classes do not fit the blocks
+    return obstaclePool().allocate();
+}
+
+void Obstacle::operator delete(void* pointer, std::size_t size) {
+    if (!pointer) return;
+    if (size != sizeof(Obstacle)) {
+        ::operator delete(pointer);
+        return;
+    }
+    obstaclePool().release(pointer);
+}
 
 /**
  * @brief constructor of the Obstacle class
@@ -18,10 +38,11 @@
  * @param x x coordinate
  * @param y y coordinate
  * @param width size of the obstacle
+ * @param handle handle of the obstacle in the engine
  * @param parent parent object
  */
-Obstacle::Obstacle(qreal x, qreal y, qreal width, QGraphicsItem *parent)
-    : QGraphicsRectItem(x - width / 2, y - width / 2, width, width, parent)
+Obstacle::Obstacle(qreal x, qreal y, qreal width, Handle handle, QGraphicsItem *parent)
+    : QGraphicsRectItem(x - width / 2, y - width / 2, width, width, parent), entity(handle)
 {
     // set white color for the obstacle
     setBrush(QBrush(Qt::white)); 
@@ -50,8 +71,7 @@ void Obstacle::mousePressEvent(QGraphicsSceneMouseEvent *event)
         if (!mainWindow) return; // check if mainWindow exists
 
         if (mainWindow->isDeletingModeActive()) {
-            scene->removeItem(this);
-            delete this; // delete the obstacle
+            mainWindow->removeObstacle(this); // delete the obstacle
         }
     }
 }
@@ -7,6 +7,7 @@
 #define OBSTACLE_H
 
 #include <QGraphicsRectItem>
+#include "slotmap.h"
 
 /**
  * @class Obstacle
@@ -16,10 +17,18 @@
 class Obstacle : public QGraphicsRectItem
 {
 public:
-    Obstacle(qreal x, qreal y, qreal width, QGraphicsItem *parent = nullptr);
+    Obstacle(qreal x, qreal y, qreal width, Handle handle, QGraphicsItem *parent = nullptr);
+    Handle handle() const { return entity; }
+
+    // obstacles are allocated from a fixed-size block pool instead of one heap allocation each
+    static void* operator new(std::size_t size);
+    static void operator delete(void* pointer, std::size_t size);
 
 protected:
     void mousePressEvent(QGraphicsSceneMouseEvent *event) override;  // mouse press event handler
 
+private:
+    Handle entity;  // handle of the obstacle in the engine
+
 #endif // OBSTACLE_H
 };
@@ -0,0 +1,455 @@
+/**
+ * @file partition.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Simulation of one world split into regions run by separate processes
+ * @details usage: simulation --partition N [--ticks T] [--every K] [--halo W] [--fixed]
+ * [--generate OBSTACLES ROBOTS] [scene.txt]
+ *
+ * The world is cut into N vertical strips of equal width, every strip is simulated
+ * by a forked process which creates only the robots and sources inside its strip and
+ * the obstacles within the sensing reach of it, the sinks are everywhere. Before every tick the neighbours exchange their robots within
+ * the halo width of the common border (World::setHalo()), after the tick the robots
+ * which crossed a border move to the neighbour (World::robotRecord(), World::insertRobot()).
+ * The regions use synchronous sensing, so the result does not depend on the split:
+ * every K ticks the processes report the hash of their robots and obstacles and the sum
+ * is compared with a single process run of the whole world, which is built only after the
+ * regions finish, so no process holds more than its part of the world meanwhile.
+ */
+#include "partition.h"
+#include "scene.h"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * @brief Options of the partitioned run
+ */
+struct PartitionOptions {
+    long regions = 0;
+    long ticks = 1000;
+    long every = 100;  // ticks between two compared hashes
+    double halo = 0;  // 0 uses World::sensingReach()
+    bool fixedPoint = false;
+    long generatedObstacles = 0;
+    long generatedRobots = 0;
+    std::string scene;
+};
+
+/**
+ * @brief State of one region reported to the parent process
+ */
+struct RegionReport {
+    long tick;
+    std::uint64_t hash;  // content hash of the robots and the obstacles of the region
+    std::uint64_t robots;
+    std::uint64_t migrations;  // robots sent to the neighbours so far
+};
+
+/**
+ * @brief Parse command line arguments following --partition
+ *
+ * @return false on invalid arguments
+ */
+static bool parseOptions(int argc, char *argv[], PartitionOptions& options) {
+    if (argc < 1) return false;
+    options.regions = std::strtol(argv[0], nullptr, 10);
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--fixed") {
+            options.fixedPoint = true;
+        } else if ((arg == "--ticks" || arg == "--every") && i + 1 < argc) {
+            long value = std::strtol(argv[++i], nullptr, 10);
+            if (value <= 0) return false;
+            (arg == "--ticks" ? options.ticks : options.every) = value;
+        } else if (arg == "--halo" && i + 1 < argc) {
+            options.halo = std::strtod(argv[++i], nullptr);
+            if (options.halo <= 0) return false;
+        } else if (arg == "--generate" && i + 2 < argc) {
+            options.generatedObstacles = std::strtol(argv[++i], nullptr, 10);
+            options.generatedRobots = std::strtol(argv[++i], nullptr, 10);
+            if (options.generatedObstacles < 0 || options.generatedRobots < 0) return false;
+        } else if (!arg.empty() && arg[0] != '-' && options.scene.empty()) {
+            options.scene = arg;
+        } else {
+            return false;
+        }
+    }
+    bool generated = options.generatedObstacles > 0 || options.generatedRobots > 0;
+    return options.regions > 0 && options.scene.empty() == generated;
+}
+
+/**
+ * @brief Create the world, or the area of it, in the synchronous mode the regions use
+ *
+ * @param scene loaded scene, unused for a generated world
+ * @param area robots and obstacles outside of it are skipped
+ */
+static void buildWorld(const PartitionOptions& options, const Scene& scene, World& world,
+                       const SceneArea& area = SceneArea()) {
+    if (options.scene.empty()) {
+        generateWorld(world, options.generatedObstacles, options.generatedRobots, 42, area);
+    } else {
+        populateWorld(world, scene, area);
+    }
+    world.setFixedPoint(options.fixedPoint || world.fixedPoint());
+    world.setSynchronousSensing(true);
+    // the schedules are reset by every halo exchange, the regions sense every tick
+    world.setSenseInterval(RobotKind::Autonomous, 1);
+    world.setSenseInterval(RobotKind::Remote, 1);
+    world.setKineticScheduling(false);
+    world.setFarSenseInterval(1);
+}
+
+/**
+ * @brief Hash of the robots of the world, see World::contentHash()
+ */
+static std::uint64_t robotHash(const World& world) {
+    std::uint64_t hash = 0;
+    for (std::size_t i = 0; i < world.autonomous.size() + world.remote.size(); ++i) {
+        hash += world.entityState(i, false).hash;
+    }
+    return hash;
+}
+
+/**
+ * @brief Write the whole buffer to the descriptor
+ */
+static bool writeAll(int fd, const void* data, std::size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written <= 0) return false;
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief Read exactly size bytes from the descriptor
+ */
+static bool readAll(int fd, void* data, std::size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = read(fd, bytes, size);
+        if (received <= 0) return false;
+        bytes += received;
+        size -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+/**
+ * @brief Send a vector prefixed by its length, the processes share the binary so raw bytes are used
+ */
+template <typename T>
+static bool sendVector(int fd, const std::vector<T>& items) {
+    std::uint64_t count = items.size();
+    return writeAll(fd, &count, sizeof(count)) && writeAll(fd, items.data(), count * sizeof(T));
+}
+
+template <typename T>
+static bool receiveVector(int fd, std::vector<T>& items) {
+    std::uint64_t count = 0;
+    if (!readAll(fd, &count, sizeof(count))) return false;
+    items.resize(count);
+    return readAll(fd, items.data(), count * sizeof(T));
+}
+
+/**
+ * @brief Process simulating one strip of the world
+ */
+class Region {
+public:
+    Region(long rank, long regions, double minX, double maxX) : rank(rank), regions(regions), minX(minX), maxX(maxX) {}
+
+    int left = -1;  // socket to the neighbour on the left, -1 at the border of the world
+    int right = -1;
+
+    /**
+     * @brief Part of the world the region creates, the strip and the obstacles within the margin of it
+     * @details the robots on the borders of the strip are created by both neighbours, restrict() removes them
+     */
+    SceneArea area(double margin) const {
+        SceneArea area;
+        area.robots.minX = rank == 0 ? -SceneArea::inf : minX;
+        area.robots.maxX = rank == regions - 1 ? SceneArea::inf : maxX;
+        area.obstacles.minX = area.robots.minX - margin;
+        area.obstacles.maxX = area.robots.maxX + margin;
+        return area;
+    }
+
+    /**
+     * @brief Keep the robots and sources inside the strip, the sinks stay everywhere
+     */
+    void restrict(World& world) const {
+        std::vector<Handle> outside;
+        world.forEachRobot([&](RobotKind, Handle handle, const Position& position, const Heading&, const ParamBlock&) {
+            if (!owns(position.x)) outside.push_back(handle);
+        });
+        for (Handle handle : outside) {
+            world.removeRobot(handle);
+        }
+        world.sources.erase(std::remove_if(world.sources.begin(), world.sources.end(),
+                                           [&](const Source& source) { return !owns(source.x); }),
+                            world.sources.end());
+    }
+
+    /**
+     * @brief Exchange the robots near the borders and set them as the halo of the world
+     */
+    bool exchangeHalo(World& world, double width) {
+        const Box& bounds = world.bounds();
+        std::vector<HaloRobot> toLeft = world.haloRobots(Box{minX, bounds.minY, minX + width, bounds.maxY});
+        std::vector<HaloRobot> toRight = world.haloRobots(Box{maxX - width, bounds.minY, maxX, bounds.maxY});
+        std::vector<HaloRobot> fromLeft, fromRight;
+        if (!exchange(toLeft, fromLeft, toRight, fromRight)) return false;
+        fromLeft.insert(fromLeft.end(), fromRight.begin(), fromRight.end());
+        world.setHalo(fromLeft);
+        return true;
+    }
+
+    /**
+     * @brief Move the robots which left the strip to the neighbours and take theirs
+     */
+    bool migrate(World& world) {
+        std::vector<RobotRecord> toLeft, toRight, fromLeft, fromRight;
+        std::vector<Handle> leaving;
+        world.forEachRobot([&](RobotKind, Handle handle, const Position& position, const Heading&, const ParamBlock&) {
+            if (owns(position.x)) return;
+            (position.x < minX ? toLeft : toRight).push_back(world.robotRecord(handle));
+            leaving.push_back(handle);
+        });
+        if (!exchange(toLeft, fromLeft, toRight, fromRight)) return false;
+        for (Handle handle : leaving) {
+            world.removeRobot(handle);
+        }
+        for (const RobotRecord& record : fromLeft) {
+            world.insertRobot(record);
+        }
+        for (const RobotRecord& record : fromRight) {
+            world.insertRobot(record);
+        }
+        migrations += leaving.size();
+        return true;
+    }
+
+    std::uint64_t migrated() const { return migrations; }
+
+    /**
+     * @brief Hash of the obstacles whose center lies in the strip, so every obstacle is counted by one region
+     */
+    std::uint64_t obstacleHash(const World& world) const {
+        std::uint64_t hash = 0;
+        std::size_t robots = world.autonomous.size() + world.remote.size();
+        for (std::size_t i = 0; i < world.obstacles.size(); ++i) {
+            EntityState state = world.entityState(robots + i, false);
+            hash += owns(state.x) ? state.hash : 0;
+        }
+        return hash;
+    }
+
+private:
+    long rank;
+    long regions;
+    double minX, maxX;
+    std::uint64_t migrations = 0;
+
+    bool owns(double x) const {
+        return (rank == 0 || x >= minX) && (rank == regions - 1 || x < maxX);
+    }
+
+    /**
+     * @brief Swap messages with both neighbours without a deadlock
+     * @details on every link the left process sends first, even ranks serve their right link
+     * first and odd ranks their left one, so both ends of a link serve it at the same time
+     */
+    template <typename T>
+    bool exchange(const std::vector<T>& toLeft, std::vector<T>& fromLeft,
+                  const std::vector<T>& toRight, std::vector<T>& fromRight) {
+        auto serveLeft = [&]() {
+            return left < 0 || (receiveVector(left, fromLeft) && sendVector(left, toLeft));
+        };
+        auto serveRight = [&]() {
+            return right < 0 || (sendVector(right, toRight) && receiveVector(right, fromRight));
+        };
+        return rank % 2 == 0 ? serveRight() && serveLeft() : serveLeft() && serveRight();
+    }
+};
+
+/**
+ * @brief Body of the forked process of one region
+ *
+ * @param report pipe to the parent process
+ * @return int exit code of the process
+ */
+static int runRegion(const PartitionOptions& options, const Scene& scene, Region& region, double haloWidth, double reach,
+                     int report) {
+    World world;
+    buildWorld(options, scene, world, region.area(std::max(haloWidth, reach)));
+    region.restrict(world);
+    std::uint64_t obstacles = region.obstacleHash(world);  // the obstacles do not change
+
+    auto send = [&](long tick) {
+        RegionReport state{tick, robotHash(world) + obstacles, world.autonomous.size() + world.remote.size(),
+                           region.migrated()};
+        return writeAll(report, &state, sizeof(state));
+    };
+    if (!send(0)) return 1;
+    for (long tick = 1; tick <= options.ticks; ++tick) {
+        if (!region.exchangeHalo(world, haloWidth)) return 1;
+        world.step();
+        if (!region.migrate(world)) return 1;
+        if ((tick % options.every == 0 || tick == options.ticks) && !send(tick)) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Entry point of the partitioned run
+ *
+ * @param argc number of arguments following --partition
+ * @param argv arguments following --partition
+ * @return int exit code, 1 when the regions differ from the whole world
+ */
+int runPartition(int argc, char *argv[]) {
+    PartitionOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: simulation --partition N [--ticks T] [--every K] [--halo W] [--fixed] "
+                             "[--generate OBSTACLES ROBOTS] [scene.txt]\n");
+        return 2;
+    }
+
+    // loaded once, the forked regions share it
+    Scene scene;
+    if (!options.scene.empty() && !loadScene(options.scene, scene)) {
+        std::fprintf(stderr, "Cannot open file for reading: %s\n", options.scene.c_str());
+        return 2;
+    }
+    // the robots, sources and templates give the reach, the obstacles are left out
+    Box bounds;
+    double reach = 0;
+    {
+        World probe;
+        SceneArea robotsOnly;
+        robotsOnly.obstacles = Box{SceneArea::inf, SceneArea::inf, -SceneArea::inf, -SceneArea::inf};
+        buildWorld(options, scene, probe, robotsOnly);
+        bounds = probe.bounds();
+        reach = probe.sensingReach();
+    }
+    double stripWidth = (bounds.maxX - bounds.minX) / options.regions;
+    double haloWidth = options.halo > 0 ? options.halo : reach;
+    if (options.regions > 1 && stripWidth < haloWidth) {
+        std::fprintf(stderr, "Strips of %.0f px are narrower than the halo of %.0f px, use fewer regions\n",
+                     stripWidth, haloWidth);
+        return 2;
+    }
+    std::printf("%ld regions of %.0f px, halo %.0f px\n", options.regions, stripWidth, haloWidth);
+    std::fflush(stdout);
+
+    // links[i] connects region i with region i + 1
+    std::vector<int> links(2 * (options.regions - 1));
+    for (long i = 0; i + 1 < options.regions; ++i) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, &links[2 * i]) != 0) {
+            std::perror("socketpair");
+            return 2;
+        }
+    }
+    std::vector<int> reports(options.regions);
+    std::vector<pid_t> children(options.regions);
+    auto start = std::chrono::steady_clock::now();
+    for (long rank = 0; rank < options.regions; ++rank) {
+        int pipeEnds[2];
+        if (pipe(pipeEnds) != 0) {
+            std::perror("pipe");
+            return 2;
+        }
+        children[rank] = fork();
+        if (children[rank] < 0) {
+            std::perror("fork");
+            return 2;
+        }
+        if (children[rank] == 0) {
+            Region region(rank, options.regions, bounds.minX + rank * stripWidth, bounds.minX + (rank + 1) * stripWidth);
+            region.left = rank > 0 ? links[2 * (rank - 1) + 1] : -1;
+            region.right = rank + 1 < options.regions ? links[2 * rank] : -1;
+            for (long i = 0; i < 2 * (options.regions - 1); ++i) {
+                if (links[i] != region.left && links[i] != region.right) close(links[i]);
+            }
+            close(pipeEnds[0]);
+            std::_Exit(runRegion(options, scene, region, haloWidth, reach, pipeEnds[1]));
+        }
+        close(pipeEnds[1]);
+        reports[rank] = pipeEnds[0];
+    }
+    for (int link : links) {
+        close(link);
+    }
+
+    // the regions report the same ticks in the same order
+    std::vector<RegionReport> merged;
+    for (bool open = true; open;) {
+        RegionReport sum{0, 0, 0, 0};
+        for (long rank = 0; rank < options.regions && open; ++rank) {
+            RegionReport state;
+            open = readAll(reports[rank], &state, sizeof(state));
+            sum = RegionReport{state.tick, sum.hash + state.hash, sum.robots + state.robots, sum.migrations + state.migrations};
+        }
+        if (open) merged.push_back(sum);
+    }
+    bool failed = false;
+    for (long rank = 0; rank < options.regions; ++rank) {
+        int status = 0;
+        waitpid(children[rank], &status, 0);
+        failed = failed || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+        close(reports[rank]);
+    }
+    double partitionedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (failed || merged.empty() || merged.back().tick != options.ticks) {
+        std::fprintf(stderr, "A region process failed\n");
+        return 2;
+    }
+
+    World reference;
+    buildWorld(options, scene, reference);
+    start = std::chrono::steady_clock::now();
+    int mismatches = 0;
+    std::size_t next = 0;
+    for (long tick = 0; tick <= options.ticks && next < merged.size(); ++tick) {
+        if (tick > 0) {
+            reference.step();
+        }
+        if (merged[next].tick != tick) continue;
+        std::uint64_t hash = reference.contentHash();
+        bool match = hash == merged[next].hash;
+        mismatches += match ? 0 : 1;
+        std::printf("tick %ld: %s hash %016" PRIx64 ", whole world %016" PRIx64 ", %" PRIu64 " robots, %" PRIu64 " migrations\n",
+                    tick, match ? "MATCH" : "DIFFER", merged[next].hash, hash, merged[next].robots, merged[next].migrations);
+        ++next;
+    }
+    double referenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("partitioned %.3f s (%.1f ticks/sec), whole world %.3f s (%.1f ticks/sec)\n",
+                partitionedSeconds, options.ticks / partitionedSeconds, referenceSeconds, options.ticks / referenceSeconds);
+    std::printf("%d of %zu checkpoints differ\n", mismatches, merged.size());
+    return mismatches > 0 ? 1 : 0;
+}
+
+#else
+
+int runPartition(int, char *[]) {
+    std::fprintf(stderr, "--partition is not supported on this platform, the regions are forked processes\n");
+    return 2;
+}
+
+#endif
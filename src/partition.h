@@ -0,0 +1,12 @@
+/**
+ * @file partition.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Simulation of one world split into regions run by separate processes
+ */
+#ifndef PARTITION_H
+#define PARTITION_H
+
+int runPartition(int argc, char *argv[]);
+
+#endif // PARTITION_H
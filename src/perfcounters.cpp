@@ -0,0 +1,100 @@
+/**
+ * @file perfcounters.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Hardware performance counters read through perf_event_open
+ */
+#include "perfcounters.h"
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @brief Open one counter of the calling thread
+ *
+ * @return file descriptor or -1
+ */
+static int openCounter(std::uint32_t type, std::uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+PerfCounters::PerfCounters() {
+    static const std::uint64_t l1ReadMiss = PERF_COUNT_HW_CACHE_L1D
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    descriptors[Cycles] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    descriptors[Instructions] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    descriptors[L1Misses] = openCounter(PERF_TYPE_HW_CACHE, l1ReadMiss);
+    descriptors[LlcMisses] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    descriptors[BranchMisses] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    if (!available()) {
+        failure = std::string("perf_event_open: ") + std::strerror(errno);
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int descriptor : descriptors) {
+        if (descriptor >= 0) close(descriptor);
+    }
+}
+
+/**
+ * @brief Read all counters
+ * @details when the kernel multiplexes the counters, values are scaled by the
+ * share of time the counter was running
+ */
+PerfSample PerfCounters::read() const {
+    PerfSample sample;
+    for (int i = 0; i < perfEventCount; ++i) {
+        if (descriptors[i] < 0) continue;
+        std::uint64_t data[3];  // value, time enabled, time running
+        if (::read(descriptors[i], data, sizeof(data)) != sizeof(data)) continue;
+        sample.values[i] = data[2] > 0 && data[2] < data[1]
+            ? static_cast<std::uint64_t>(double(data[0]) * data[1] / data[2]) : data[0];
+    }
+    return sample;
+}
+
+#else
+
+PerfCounters::PerfCounters() : failure("hardware counters are supported on Linux only") {
+    for (int& descriptor : descriptors) descriptor = -1;
+}
+
+PerfCounters::~PerfCounters() {
+}
+
+PerfSample PerfCounters::read() const {
+    return PerfSample{};
+}
+
+#endif
+
+bool PerfCounters::available() const {
+    for (int descriptor : descriptors) {
+        if (descriptor >= 0) return true;
+    }
+    return false;
+}
+
+const char* PerfCounters::name(PerfEvent event) {
+    switch (event) {
+        case Cycles: return "cycles";
+        case Instructions: return "instructions";
+        case L1Misses: return "L1 misses";
+        case LlcMisses: return "LLC misses";
+        case BranchMisses: return "branch misses";
+        default: return "";
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * @file perfcounters.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Hardware performance counters read through perf_event_open
+ */
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Hardware events counted by PerfCounters
+ */
+enum PerfEvent {
+    Cycles,
+    Instructions,
+    L1Misses,  // L1 data cache read misses
+    LlcMisses,  // last level cache misses
+    BranchMisses,
+    perfEventCount
+};
+
+/**
+ * @brief Values of all counters at one moment, or a difference of two moments
+ */
+struct PerfSample {
+    std::uint64_t values[perfEventCount] = {};
+
+    PerfSample operator-(const PerfSample& other) const {
+        PerfSample result;
+        for (int i = 0; i < perfEventCount; ++i) {
+            result.values[i] = values[i] - other.values[i];
+        }
+        return result;
+    }
+
+    PerfSample& operator+=(const PerfSample& other) {
+        for (int i = 0; i < perfEventCount; ++i) {
+            values[i] += other.values[i];
+        }
+        return *this;
+    }
+};
+
+/**
+ * @class PerfCounters
+ * @brief Counters of the calling thread in user space, counting from construction
+ * @details events the kernel or the CPU refuse are reported as unavailable,
+ * on other systems than Linux nothing is available and read() returns zeros
+ */
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const;
+    bool available(PerfEvent event) const { return descriptors[event] >= 0; }
+
+    /**
+     * @brief Why no counter could be opened, empty when some are available
+     */
+    const std::string& error() const { return failure; }
+
+    PerfSample read() const;
+    static const char* name(PerfEvent event);
+
+private:
+    int descriptors[perfEventCount];
+    std::string failure;
+};
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,205 @@
+/**
+ * @file regress.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Headless regression check of behavior and throughput against stored baselines
+ * @details usage: simulation --regress [--update] [--no-perf] [--runs N] [--tolerance T] baseline.txt
+ *
+ * The baseline file uses the scene file syntax, every Case{} block names a
+ * scene (or generated obstacles and robots), optionally fixedPoint = 1, senseInterval = N and kinetic = 1, the number of ticks, the golden
+ * state hash and the expected ticks per second. A case fails when the hash
+ * differs or the median throughput of N runs (default 3) drops below the expectation
+ * by more than the tolerance; with --no-perf every case runs once and only the hash counts.
+ */
+#include "regress.h"
+#include "scene.h"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Options of the regression run
+ */
+struct RegressOptions {
+    bool update = false;  // store the measured values as the new baseline
+    bool checkPerformance = true;
+    double tolerance = 0.3;  // allowed relative drop of ticks per second
+    long runs = 3;  // runs of a case whose median throughput is compared
+    std::string baseline;
+};
+
+/**
+ * @brief Parse command line arguments following --regress
+ *
+ * @return false on invalid arguments
+ */
+static bool parseOptions(int argc, char *argv[], RegressOptions& options) {
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--update") {
+            options.update = true;
+        } else if (arg == "--no-perf") {
+            options.checkPerformance = false;
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            options.tolerance = std::strtod(argv[++i], nullptr);
+            if (options.tolerance < 0 || options.tolerance >= 1) return false;
+        } else if (arg == "--runs" && i + 1 < argc) {
+            options.runs = std::strtol(argv[++i], nullptr, 10);
+            if (options.runs <= 0) return false;
+        } else if (!arg.empty() && arg[0] != '-' && options.baseline.empty()) {
+            options.baseline = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.baseline.empty();
+}
+
+/**
+ * @brief Create the world of the case
+ *
+ * @return false if the scene can not be loaded
+ */
+static bool buildWorld(const SceneObject& testCase, World& world, std::string& name) {
+    if (testCase.has("scene")) {
+        name = testCase.attributes.at("scene");
+        Scene scene;
+        if (!loadScene(name, scene)) {
+            std::fprintf(stderr, "Cannot open file for reading: %s\n", name.c_str());
+            return false;
+        }
+        populateWorld(world, scene);
+    } else {
+        long obstacles = testCase.intValue("obstacles");
+        long robots = testCase.intValue("robots");
+        name = "generated " + std::to_string(obstacles) + " obstacles, " + std::to_string(robots) + " robots";
+        generateWorld(world, obstacles, robots, testCase.has("seed") ? testCase.intValue("seed") : 42);
+    }
+    if (testCase.has("fixedPoint")) {
+        world.setFixedPoint(testCase.intValue("fixedPoint") != 0);
+        name += testCase.intValue("fixedPoint") != 0 ? " (fixed point)" : "";
+    }
+    if (testCase.has("senseInterval")) {
+        world.setSenseInterval(RobotKind::Autonomous, testCase.intValue("senseInterval"));
+        world.setSenseInterval(RobotKind::Remote, testCase.intValue("senseInterval"));
+        name += " (sense every " + std::to_string(world.senseInterval(RobotKind::Autonomous)) + " ticks)";
+    }
+    if (testCase.intValue("kinetic") != 0) {
+        world.setKineticScheduling(true);
+        name += " (kinetic)";
+    }
+    return true;
+}
+
+/**
+ * @brief Run one case and compare it with its baseline, the measured values are stored into the case
+ * @details the throughput of a single run depends on what else the machine does, the median of
+ * several runs is compared instead; every run must end in the same state
+ *
+ * @return false if the case failed
+ */
+static bool runCase(SceneObject& testCase, const RegressOptions& options) {
+    long ticks = testCase.intValue("ticks");
+    long runs = options.checkPerformance || options.update ? options.runs : 1;
+    std::vector<double> rates;
+    std::string name;
+    char hash[17] = {};
+    bool stable = true;
+    for (long run = 0; run < runs; ++run) {
+        World world;
+        if (!buildWorld(testCase, world, name)) {
+            return false;
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (long tick = 0; tick < ticks; ++tick) {
+            world.step();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        rates.push_back(seconds > 0 ? ticks / seconds : 0.0);
+
+        char runHash[17];
+        std::snprintf(runHash, sizeof(runHash), "%016" PRIx64, world.stateHash());
+        stable = stable && (run == 0 || std::string(runHash) == hash);
+        std::snprintf(hash, sizeof(hash), "%s", runHash);
+    }
+    std::nth_element(rates.begin(), rates.begin() + rates.size() / 2, rates.end());
+    double ticksPerSecond = rates[rates.size() / 2];
+
+    std::string expectedHash = testCase.has("hash") ? testCase.attributes.at("hash") : std::string();
+    double expectedRate = testCase.doubleValue("ticksPerSecond");
+
+    bool hashOk = stable && (options.update || expectedHash == hash);
+    bool rateOk = options.update || !options.checkPerformance || expectedRate <= 0
+        || ticksPerSecond >= expectedRate * (1 - options.tolerance);
+
+    std::printf("%s %s (%ld ticks)\n", hashOk && rateOk ? "PASS" : "FAIL", name.c_str(), ticks);
+    std::printf("  hash %s%s%s%s\n", hash, hashOk ? "" : ", expected ", hashOk ? "" : expectedHash.c_str(),
+                stable ? "" : ", the runs ended in different states");
+    std::printf("  ticks/sec %.1f (median of %ld runs), baseline %.1f\n", ticksPerSecond, runs, expectedRate);
+
+    testCase.attributes["hash"] = hash;
+    testCase.attributes["ticksPerSecond"] = std::to_string(static_cast<long>(ticksPerSecond));
+    return hashOk && rateOk;
+}
+
+/**
+ * @brief Write the cases back to the baseline file
+ */
+static bool saveBaseline(const std::string& filename, const Scene& cases) {
+    std::ofstream file(filename);
+    if (!file) {
+        return false;
+    }
+    file << "# regression baseline, regenerate with: simulation --regress --update " << filename << "\n";
+    for (const SceneObject& testCase : cases.objects) {
+        file << testCase.type << "{\n";
+        for (const auto& attribute : testCase.attributes) {
+            file << "    " << attribute.first << " = " << attribute.second << "\n";
+        }
+        file << "}\n";
+    }
+    return true;
+}
+
+/**
+ * @brief Entry point of the regression check
+ *
+ * @param argc number of arguments following --regress
+ * @param argv arguments following --regress
+ * @return int exit code, 1 when any case failed
+ */
+int runRegression(int argc, char *argv[]) {
+    RegressOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: simulation --regress [--update] [--no-perf] [--runs N] [--tolerance T] baseline.txt\n");
+        return 2;
+    }
+
+    Scene cases;
+    if (!loadScene(options.baseline, cases)) {
+        std::fprintf(stderr, "Cannot open file for reading: %s\n", options.baseline.c_str());
+        return 2;
+    }
+
+    int failed = 0;
+    int total = 0;
+    for (SceneObject& testCase : cases.objects) {
+        if (testCase.type != "Case") continue;
+        ++total;
+        if (!runCase(testCase, options)) {
+            ++failed;
+        }
+    }
+
+    if (options.update && !saveBaseline(options.baseline, cases)) {
+        std::fprintf(stderr, "Cannot open file for writing: %s\n", options.baseline.c_str());
+        return 2;
+    }
+    std::printf("%d of %d cases failed\n", failed, total);
+    return failed > 0 ? 1 : 0;
+}
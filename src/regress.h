@@ -0,0 +1,12 @@
+/**
+ * @file regress.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Headless regression check of behavior and throughput against stored baselines
+ */
+#ifndef REGRESS_H
+#define REGRESS_H
+
+int runRegression(int argc, char *argv[]);
+
+#endif // REGRESS_H
@@ -2,271 +2,134 @@
  * @file robots.cpp
  * @author Yaroslav Slabik  (xslabi01)
  * @author Kininbayev Timur (xkinin00)
- * @brief File containing the robot class logic
+ * @brief File containing the robot view logic
  */
-#include <cmath>  // For cos() and sin()
 #include <QGraphicsItem>
 #include <QPainter>
 #include "mainwindow.h"
+#include "geometry.h"
+#include "arena.h"
 #include "qgraphicsscene.h"
 #include "qgraphicsview.h"
-#include "obstacle.h"
 #include "qgraphicssceneevent.h"
 
 /**
- * @brief delete the robot if the left mouse button is pressed and the deleting mode is active
- * 
- * @param event 
+ * @brief constructor of the Robot view
+ *
+ * @param kind kind of the robot in the engine
+ * @param handle handle of the robot in the engine
  */
-void AutonomousRobot::mousePressEvent(QGraphicsSceneMouseEvent *event)
-{
-    if (event->button() == Qt::LeftButton) {
-        auto scene = this->scene();
-        if (!scene) return;
-
-        auto views = scene->views();
-        if (views.isEmpty()) return;
-
-        QGraphicsView* view = views.first(); // take the first view
-        if (!view) return;
-
-        MainWindow *mainWindow = dynamic_cast<MainWindow *>(view->window());
-        if (!mainWindow) return; // check if mainWindow exists
-
-        if (mainWindow->isRobotDeletingModeActive()) {
-            scene->removeItem(this);
-            mainWindow->autonomousRobots.removeOne(this);
-            delete this; // delete the robot
-            scene->update(); // update the scene
-        }
-    }
+Robot::Robot(RobotKind kind, Handle handle)
+    : robotKind(kind), entity(handle) {
+    color = defaultColor();
 }
 
-/**
- * @brief select or delete the remote controlled robot if the left mouse button is pressed
- * 
- * @param event mouse event
- */
-void RemoteRobot::mousePressEvent(QGraphicsSceneMouseEvent *event) {
-    if (event->button() == Qt::LeftButton) {
-        auto scene = this->scene();
-        if (!scene) return;
-
-        auto views = scene->views();
-        if (views.isEmpty()) return;
-
-        QGraphicsView* view = views.first();
-        if (!view) return;
-
-        MainWindow *mainWindow = dynamic_cast<MainWindow *>(view->window());
-        if (!mainWindow) return;
-
-        if (mainWindow->isRobotDeletingModeActive()) {
-            scene->removeItem(this);
-            if (mainWindow->selectedRobot == this) {
-                mainWindow->selectRobot(nullptr);  // Clear the selected robot if it is the one being deleted
-            }
-            mainWindow->remoteRobots.removeOne(this);  // Remove from the list
-            delete this;  // Delete the object
-            scene->update();  // Update the view
-            return;  // Exit to avoid further processing since the object is deleted
-        }
-
-        if (mainWindow->selectedRobot){
-            mainWindow->selectedRobot->setColor(Qt::magenta);
-        }
-        setColor(Qt::yellow);
-        setSelected(true);
-        mainWindow->selectRobot(this);
-        QGraphicsItem::update();
-    }
+static BlockPool& robotPool() {
+    static BlockPool pool(sizeof(Robot));
+    return pool;
 }
 
-/**
- * @brief handle the autonomous robot movement
- * 
- */
-void AutonomousRobot::move() {
-    double radAngle = orientation * M_PI / 180;
-    double dx = speed * cos(radAngle);
-    double dy = speed * sin(radAngle);
-
-    positionX += dx;
-    positionY += dy;
-
-    // Use QGraphicsItem's setPos to handle updating the scene position
-    setPos(positionX, positionY);
+void* Robot::operator new(std::size_t size) {
+    if (size != sizeof(Robot)) return ::operator new(size);  // derived classes do not fit the blocks
+    return robotPool().allocate();
 }
 
-/**
- * @brief detect obstacles in the robot's path
- * 
- * @return true when an obstacle is detected
- * @return false when no obstacles are detected
- */
-bool AutonomousRobot::detectObstacle() {
-    qDebug() << "Checking for obstacles for robot at position" << positionX << positionY;
-
-    double radOrientation = orientation * M_PI / 180;
-    double robotRadius = 20;  // Radius of the robot
-    double halfTopWidth = detectionRadius * tan(M_PI / 6); // Half width at the detection radius
-    double halfBaseWidth = halfTopWidth / 4;  // Half width at the robot
-    if (halfBaseWidth > robotRadius / 3) {
-        halfBaseWidth = robotRadius / 3;
-    }
-
-    // Calculate trapezoid corners relative to robot center
-    QPointF baseLeft(robotRadius, -halfBaseWidth);
-    QPointF baseRight(robotRadius, halfBaseWidth);
-    QPointF topRight(detectionRadius + robotRadius, halfTopWidth);
-    QPointF topLeft(detectionRadius + robotRadius, -halfTopWidth);
-
-    // Rotate points around the robot's center at (0,0)
-    baseLeft = rotatePoint(baseLeft, radOrientation);
-    baseRight = rotatePoint(baseRight, radOrientation);
-    topRight = rotatePoint(topRight, radOrientation);
-    topLeft = rotatePoint(topLeft, radOrientation);
-
-    QPainterPath detectionPath;
-    detectionPath.moveTo(baseLeft + QPointF(positionX, positionY));
-    detectionPath.lineTo(baseRight + QPointF(positionX, positionY));
-    detectionPath.lineTo(topRight + QPointF(positionX, positionY));
-    detectionPath.lineTo(topLeft + QPointF(positionX, positionY));
-    detectionPath.closeSubpath();
-
-    QGraphicsScene* currentScene = scene();
-    QRectF sceneRect = currentScene->sceneRect();
-
-    if (!sceneRect.contains(detectionPath.boundingRect())) {
-        qDebug() << "Obstacle detected: out of scene bounds";
-        return true;
-    }
-
-    QList<QGraphicsItem*> collidingItems = currentScene->items(detectionPath);
-    foreach(QGraphicsItem *item, collidingItems) {
-        if (item != this && (dynamic_cast<Obstacle*>(item) || dynamic_cast<Robot*>(item))) {
-            qDebug() << "Obstacle detected: collision with an obstacle";
-            return true;
-        }
+void Robot::operator delete(void* pointer, std::size_t size) {
+    if (!pointer) return;
+    if (size != sizeof(Robot)) {
+        ::operator delete(pointer);
+        return;
     }
-
-    qDebug() << "No obstacles detected";
-    return false;
+    robotPool().release(pointer);
 }
 
 /**
- * @brief handling the remote robot movement
- * If obstacle is detected, the robot stops
+ * @brief color of the robot when it is not selected
  */
-void RemoteRobot::moveForward() {
-    if(detectObstacle()){
-        isMoving = false;
-        return;
-    }
-
-    double radAngle = orientation * M_PI / 180;
-    double dx = speed * cos(radAngle);
-    double dy = speed * sin(radAngle);
-
-    positionX += dx;
-    positionY += dy;
-
-    isMoving = true;
-    rotationDirection = NoRotation;
-
-    setPos(positionX, positionY);
+QColor Robot::defaultColor() const {
+    return robotKind == RobotKind::Autonomous ? QColor(Qt::blue) : QColor(Qt::magenta);
 }
 
 /**
- * @brief rotate the robot to the right
+ * @brief copy the engine state of the robot to the view
  */
-void RemoteRobot::rotateRight() {
-    stop();
-    rotationDirection = RotateRight;
-    orientation = (orientation + 1) % 360;
-    updatePosition();
+void Robot::sync(const Position& position, const Heading& heading, const ParamBlock& params) {
+    orientation = heading.orientation;
+    detectionRadius = params.detectionRadius;
+    setPos(position.x, position.y);
 }
 
-/**
- * @brief rotate the robot to the left
- */
-void RemoteRobot::rotateLeft() {
-    stop();
-    rotationDirection = RotateLeft;
-    orientation = (orientation - 1 + 360) % 360;
-    updatePosition();
+void Robot::setColor(const QColor &newColor) {
+    if (color != newColor) {  // change color only if it's different from actual
+        color = newColor;
+        QGraphicsItem::update();  // call base update method for color changing
+    }
 }
 
 /**
- * @brief stop the robot
- * 
+ * @brief Paint the robot and its field of vision
+ *
+ * @param painter
+ * @param option
+ * @param widget
  */
-void RemoteRobot::stop(){
-    isMoving = false;
-    rotationDirection = NoRotation;
-    updatePosition();
-}
-
-void RemoteRobot::updatePosition() {
-    setPos(positionX, positionY);
-}
-
-Robot::RotationDirection RemoteRobot::getRotationDirection()  {
-    return rotationDirection;
+void Robot::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    // Basic robot visualization
+    painter->setBrush(color);
+    painter->drawEllipse(boundingRect()); // Draw robot centered at its position
+
+    // Trapezoid field of vision around the robot's center at (0,0)
+    Vec2 corners[4];
+    fieldOfView(detectionRadius, orientation, corners);
+
+    QPainterPath viewField;
+    viewField.moveTo(corners[0].x, corners[0].y);
+    viewField.lineTo(corners[1].x, corners[1].y);
+    viewField.lineTo(corners[2].x, corners[2].y);
+    viewField.lineTo(corners[3].x, corners[3].y);
+    viewField.closeSubpath();
+
+    // Setting semi-transparent red for the field of vision
+    painter->setBrush(QColor(255, 0, 0, 100));
+    painter->drawPath(viewField);
 }
 
 /**
- * @brief detect obstacles in the robot's path
- * 
- * @return true if an obstacle is detected
- * @return false if no obstacles are detected
+ * @brief delete the robot if the deleting mode is active, otherwise select it if it is remote controlled
+ *
+ * @param event mouse event
  */
-bool RemoteRobot::detectObstacle() {
-    qDebug() << "Checking for obstacles for robot at position" << positionX << positionY;
-
-    double radOrientation = orientation * M_PI / 180;
-    double robotRadius = 20;  // Radius of the robot
-    double halfTopWidth = detectionRadius * tan(M_PI / 6); // Half width at the detection radius
-    double halfBaseWidth = halfTopWidth / 4;  // Half width at the robot
-    if (halfBaseWidth > robotRadius / 3) {
-        halfBaseWidth = robotRadius / 3;
-    }
+void Robot::mousePressEvent(QGraphicsSceneMouseEvent *event) {
+    if (event->button() == Qt::LeftButton) {
+        auto scene = this->scene();
+        if (!scene) return;
 
-    // Calculate trapezoid corners relative to robot center
-    QPointF baseLeft(robotRadius, -halfBaseWidth);
-    QPointF baseRight(robotRadius, halfBaseWidth);
-    QPointF topRight(detectionRadius + robotRadius, halfTopWidth);
-    QPointF topLeft(detectionRadius + robotRadius, -halfTopWidth);
+        auto views = scene->views();
+        if (views.isEmpty()) return;
 
-    // Rotate points around the robot's center at (0,0)
-    baseLeft = rotatePoint(baseLeft, radOrientation);
-    baseRight = rotatePoint(baseRight, radOrientation);
-    topRight = rotatePoint(topRight, radOrientation);
-    topLeft = rotatePoint(topLeft, radOrientation);
+        QGraphicsView* view = views.first(); // take the first view
+        if (!view) return;
 
-    QPainterPath detectionPath;
-    detectionPath.moveTo(baseLeft + QPointF(positionX, positionY));
-    detectionPath.lineTo(baseRight + QPointF(positionX, positionY));
-    detectionPath.lineTo(topRight + QPointF(positionX, positionY));
-    detectionPath.lineTo(topLeft + QPointF(positionX, positionY));
-    detectionPath.closeSubpath();
+        MainWindow *mainWindow = dynamic_cast<MainWindow *>(view->window());
+        if (!mainWindow) return; // check if mainWindow exists
 
-    QGraphicsScene* currentScene = scene();
-    QRectF sceneRect = currentScene->sceneRect();
+        if (mainWindow->isRobotDeletingModeActive()) {
+            mainWindow->removeRobot(this);  // deletes the robot
+            return;  // Exit to avoid further processing since the object is deleted
+        }
 
-    if (!sceneRect.contains(detectionPath.boundingRect())) {
-        qDebug() << "Obstacle detected: out of scene bounds";
-        return true;
-    }
+        if (robotKind != RobotKind::Remote) return;  // only remote robots can be selected
 
-    QList<QGraphicsItem*> collidingItems = currentScene->items(detectionPath);
-    foreach(QGraphicsItem *item, collidingItems) {
-        if (item != this && (dynamic_cast<Obstacle*>(item) || dynamic_cast<Robot*>(item))) {
-            qDebug() << "Obstacle detected: collision with an obstacle";
-            return true;
+        Robot *previous = mainWindow->robotItem(mainWindow->selectedRobot);
+        if (previous) {
+            previous->setColor(previous->defaultColor());
         }
+        setColor(Qt::yellow);
+        setSelected(true);
+        mainWindow->selectRobot(entity);
+        QGraphicsItem::update();
     }
-
-    qDebug() << "No obstacles detected";
-    return false;
-}
\ No newline at end of file
+}
@@ -0,0 +1,265 @@
+/**
+ * @file scene.cpp
+ * @author Kininbayev Timur (xkinin00)
+ * @author Yaroslav Slabik (xslabi01)
+ * @brief Parsing of the scene files
+ */
+#include "scene.h"
+#include "fixedpoint.h"
+#include <cerrno>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+
+static constexpr double maxWorldSide = fixedLimit;  // px, also keeps the chunk and cell counts of the grids in int
+
+/**
+ * @brief Strip whitespace from both ends
+ */
+static std::string trimmed(const std::string& text) {
+    const char* whitespace = " \t\r\n";
+    std::size_t begin = text.find_first_not_of(whitespace);
+    if (begin == std::string::npos) return std::string();
+    std::size_t end = text.find_last_not_of(whitespace);
+    return text.substr(begin, end - begin + 1);
+}
+
+/**
+ * @brief Integer value of the attribute, 0 when it is missing or not an integer
+ */
+int SceneObject::intValue(const std::string& key) const {
+    auto it = attributes.find(key);
+    if (it == attributes.end() || it->second.empty()) return 0;
+    char* end = nullptr;
+    errno = 0;
+    long value = std::strtol(it->second.c_str(), &end, 10);
+    if (*end != '\0' || errno != 0) return 0;
+    return static_cast<int>(value);
+}
+
+/**
+ * @brief Floating point value of the attribute, 0 when it is missing or not a number
+ */
+double SceneObject::doubleValue(const std::string& key) const {
+    auto it = attributes.find(key);
+    if (it == attributes.end() || it->second.empty()) return 0;
+    char* end = nullptr;
+    double value = std::strtod(it->second.c_str(), &end);
+    if (*end != '\0') return 0;
+    return value;
+}
+
+/**
+ * @brief Parse scene
+ * @details every object is a block "Type{" followed by "key = value" lines and closed by "}",
+ * blank lines and lines starting with # are skipped
+ *
+ * @param in stream with the scene
+ * @param scene parsed objects are appended here
+ */
+void parseScene(std::istream& in, Scene& scene) {
+    std::string line;
+    SceneObject current;
+    while (std::getline(in, line)) {
+        line = trimmed(line);
+        if (line.empty() || line[0] == '#') {
+            continue; // skip blanks and comments
+        }
+
+        if (line.back() == '{') {
+            // new object
+            current = SceneObject{trimmed(line.substr(0, line.size() - 1)), {}};
+        } else if (line[0] == '}') {
+            // end of object
+            if (!current.type.empty()) {
+                scene.objects.push_back(current);
+                current = SceneObject{};
+            }
+        } else {
+            std::size_t separator = line.find('=');
+            if (separator != std::string::npos && line.find('=', separator + 1) == std::string::npos) {
+                current.attributes[trimmed(line.substr(0, separator))] = trimmed(line.substr(separator + 1));
+            }
+        }
+    }
+}
+
+/**
+ * @brief Load scene from file
+ *
+ * @return false if the file can not be opened
+ */
+bool loadScene(const std::string& filename, Scene& scene) {
+    std::ifstream file(filename);
+    if (!file) {
+        return false;
+    }
+    parseScene(file, scene);
+    return true;
+}
+
+/**
+ * @brief Create the engine entity described by the object
+ * @details world settings, templates, sources and sinks are applied too, they are not entities and return null handle
+ *
+ * @return handle of the entity, null handle for other object types
+ */
+Handle addSceneObject(World& world, const SceneObject& object) {
+    int x = object.intValue("positionX");
+    int y = object.intValue("positionY");
+
+    // robot parameters come from the template, values given in the object override it
+    const ParamBlock* shared = object.has("template") ? world.findTemplate(object.attributes.at("template")) : nullptr;
+    int speed = object.has("speed") || !shared ? object.intValue("speed") : shared->speed;
+    double detectionRadius = object.has("detectionRadius") || !shared
+        ? object.doubleValue("detectionRadius") : shared->detectionRadius;
+    double avoidanceAngle = object.has("avoidanceAngle") || !shared
+        ? object.doubleValue("avoidanceAngle") : shared->avoidanceAngle;
+
+    if (object.type == "World") {
+        world.setFixedPoint(object.intValue("fixedPoint") != 0);
+        if (object.has("senseInterval")) {
+            world.setSenseInterval(RobotKind::Autonomous, object.intValue("senseInterval"));
+            world.setSenseInterval(RobotKind::Remote, object.intValue("senseInterval"));
+        }
+        world.setKineticScheduling(object.intValue("kinetic") != 0);
+        if (object.has("farSenseInterval")) {
+            world.setFarSenseInterval(object.intValue("farSenseInterval"));
+        }
+    } else if (object.type == "RobotTemplate") {
+        world.addTemplate(object.has("name") ? object.attributes.at("name") : std::string(),
+                          detectionRadius, avoidanceAngle, speed);
+    } else if (object.type == "AutonomousRobot") {
+        return world.addAutonomousRobot(x, y, object.intValue("orientation"), detectionRadius,
+                                        avoidanceAngle, speed);
+    } else if (object.type == "RemoteRobot") {
+        return world.addRemoteRobot(x, y, speed, detectionRadius);
+    } else if (object.type == "Obstacle") {
+        return world.addObstacle(x, y, object.intValue("width"));
+    } else if (object.type == "Source") {
+        Source source{};
+        source.x = x;
+        source.y = y;
+        source.orient = object.intValue("orientation");
+        source.detectionRadius = detectionRadius;
+        source.avoidanceAngle = avoidanceAngle;
+        source.speed = speed;
+        source.interval = object.has("interval") ? object.intValue("interval") : 100;
+        source.limit = object.intValue("limit");
+        world.addSource(source);
+    } else if (object.type == "Sink") {
+        world.addSink(x, y, object.intValue("width"));
+    }
+    return Handle{};
+}
+
+/**
+ * @brief Order in which the objects should be created
+ * @details world settings, templates, sources and sinks keep their order and come first, robots
+ * and obstacles follow in Z-order of their positions, so entities close in the
+ * scene are created next to each other in the engine tables
+ */
+std::vector<const SceneObject*> spatialOrder(const Scene& scene, const Box& bounds) {
+    std::vector<std::pair<std::uint64_t, const SceneObject*>> keyed;
+    keyed.reserve(scene.objects.size());
+    for (const SceneObject& object : scene.objects) {
+        bool entity = object.type == "AutonomousRobot" || object.type == "RemoteRobot" || object.type == "Obstacle";
+        std::uint64_t key = entity
+            ? (std::uint64_t(1) << 32) | mortonKey(bounds, object.intValue("positionX"), object.intValue("positionY"))
+            : 0;
+        keyed.emplace_back(key, &object);
+    }
+    std::stable_sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<const SceneObject*> order;
+    order.reserve(keyed.size());
+    for (const auto& entry : keyed) {
+        order.push_back(entry.second);
+    }
+    return order;
+}
+
+/**
+ * @brief World bounds declared by World{width = W height = H} of the scene
+ * @details sizes above maxWorldSide are rejected like non-positive ones
+ *
+ * @param fallback bounds used when the scene declares no valid bounds
+ */
+Box declaredBounds(const Scene& scene, const Box& fallback) {
+    Box bounds = fallback;
+    for (const SceneObject& object : scene.objects) {
+        double width = object.doubleValue("width");
+        double height = object.doubleValue("height");
+        if (object.type == "World" && object.has("width") && object.has("height")
+            && width > 0 && height > 0 && width <= maxWorldSide && height <= maxWorldSide) {
+            bounds = Box{0, 0, width, height};
+        }
+    }
+    return bounds;
+}
+
+/**
+ * @brief Check if the robot or obstacle of the scene lies in the area, other objects always do
+ */
+static bool insideArea(const SceneArea& area, const SceneObject& object) {
+    double x = object.intValue("positionX");
+    double y = object.intValue("positionY");
+    if (object.type == "Obstacle") {
+        double half = object.intValue("width") / 2.0;
+        return boxesIntersect(area.obstacles, Box{x - half, y - half, x + half, y + half});
+    }
+    if (object.type == "AutonomousRobot" || object.type == "RemoteRobot") {
+        return boxContains(area.robots, x, y);
+    }
+    return true;
+}
+
+/**
+ * @brief Create the objects of the scene in the world
+ * @details the declared bounds are set first, so the objects are ordered inside them
+ *
+ * @param area robots and obstacles outside of it are skipped, the whole scene by default
+ */
+void populateWorld(World& world, const Scene& scene, const SceneArea& area) {
+    world.setBounds(declaredBounds(scene, world.bounds()));
+    for (const SceneObject* object : spatialOrder(scene, world.bounds())) {
+        if (insideArea(area, *object)) {
+            addSceneObject(world, *object);
+        }
+    }
+}
+
+/**
+ * @brief Fill the world with randomly placed obstacles and autonomous robots
+ * @details the bounds grow with the number of objects, so the density stays
+ * about one object per 100x100 area, robots share eight parameter blocks.
+ * Only the raw output of the generator is used, so the same seed gives the
+ * same world with every standard library; the objects outside the area are drawn
+ * and skipped, so the kept ones do not depend on the area
+ */
+void generateWorld(World& world, long obstacles, long robots, unsigned seed, const SceneArea& area) {
+    double side = std::min(maxWorldSide, std::max(1500.0, std::sqrt((obstacles + robots) * 10000.0)));
+    world.setBounds(Box{0, 0, side, side});
+
+    std::mt19937 random(seed);
+    auto coordinate = [&]() { return 50 + random() / 4294967296.0 * (side - 100); };
+    for (long i = 0; i < obstacles; ++i) {
+        double x = coordinate();
+        double y = coordinate();
+        double width = 10 + random() % 30;
+        if (boxesIntersect(area.obstacles, Box{x - width / 2, y - width / 2, x + width / 2, y + width / 2})) {
+            world.addObstacle(x, y, width);
+        }
+    }
+    for (long i = 0; i < robots; ++i) {
+        double x = coordinate();
+        double y = coordinate();
+        int variant = static_cast<int>(random() % 8);
+        int orientation = static_cast<int>(random() % 4);
+        if (boxContains(area.robots, x, y)) {
+            world.addAutonomousRobot(x, y, orientation, 20 + 5 * variant, 30 + 5 * variant, 5 + variant);
+        }
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * @file scene.h
+ * @author Kininbayev Timur (xkinin00)
+ * @author Yaroslav Slabik (xslabi01)
+ * @brief Parsing of the scene files, shared by the GUI and the headless runs
+ */
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <istream>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+#include "world.h"
+
+/**
+ * @brief One object block of the scene file, e.g. Obstacle{ ... }
+ */
+struct SceneObject {
+    std::string type;
+    std::map<std::string, std::string> attributes;
+
+    bool has(const std::string& key) const { return attributes.count(key) != 0; }
+    int intValue(const std::string& key) const;
+    double doubleValue(const std::string& key) const;
+};
+
+/**
+ * @brief Content of a scene file
+ */
+struct Scene {
+    std::vector<SceneObject> objects;
+};
+
+/**
+ * @brief Part of the world to create, the robots and obstacles outside of it are skipped
+ * @details a robot is created when its position lies in robots, an obstacle when its square
+ * touches obstacles; settings, templates, sources and sinks are always created
+ */
+struct SceneArea {
+    static constexpr double inf = std::numeric_limits<double>::infinity();
+    Box robots{-inf, -inf, inf, inf};
+    Box obstacles{-inf, -inf, inf, inf};
+};
+
+void parseScene(std::istream& in, Scene& scene);
+bool loadScene(const std::string& filename, Scene& scene);
+Box declaredBounds(const Scene& scene, const Box& fallback);
+std::vector<const SceneObject*> spatialOrder(const Scene& scene, const Box& bounds);
+Handle addSceneObject(World& world, const SceneObject& object);
+void populateWorld(World& world, const Scene& scene, const SceneArea& area = SceneArea());
+void generateWorld(World& world, long obstacles, long robots, unsigned seed = 42, const SceneArea& area = SceneArea());
+
+#endif // SCENE_H
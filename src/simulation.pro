@@ -1,4 +1,5 @@
 QT += core gui
+CONFIG += thread
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -13,10 +14,53 @@ SOURCES += main.cpp\
            createobstacledialog.cpp\
            createRobotDialog.cpp\
            obstacle.cpp\
-           robots.cpp
+           robots.cpp\
+           world.cpp\
+           allocstats.cpp\
+           scene.cpp\
+           bench.cpp\
+           perfcounters.cpp\
+           regress.cpp\
+           threadpool.cpp\
+           trace.cpp\
+           partition.cpp\
+           worldhost.cpp\
+           sweep.cpp\
+           metrics.cpp\
+           stats.cpp\
+           ensemble.cpp\
+           jobserver.cpp\
+           whatif.cpp\
+           lookahead.cpp
 
 HEADERS += mainwindow.h\
            obstacle.h\
            createobstacledialog.h\
            createRobotDialog.h\
-           robots.h
+           robots.h\
+           geometry.h\
+           components.h\
+           archetype.h\
+           slotmap.h\
+           behaviors.h\
+           world.h\
+           arena.h\
+           spatialgrid.h\
+           allocstats.h\
+           scene.h\
+           bench.h\
+           perfcounters.h\
+           regress.h\
+           threadpool.h\
+           trace.h\
+           partition.h\
+           worldhost.h\
+           sweep.h\
+           metrics.h\
+           stats.h\
+           ensemble.h\
+           jobserver.h\
+           whatif.h\
+           lookahead.h\
+           trig.h\
+           fixedpoint.h
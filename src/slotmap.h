@@ -0,0 +1,142 @@
+/**
+ * @file slotmap.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Generational handles and the slot map resolving them to table rows
+ */
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Stable reference to an entity
+ * @details the generation is bumped every time the slot is freed, so a handle
+ * of a deleted entity never resolves, even when its slot is reused
+ */
+struct Handle {
+    std::uint32_t index = 0;
+    std::uint32_t generation = 0;  // 0 is never used by a live slot
+
+    bool isNull() const { return generation == 0; }
+    std::uint64_t key() const { return (std::uint64_t(generation) << 32) | index; }
+
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+/**
+ * @class SlotMap
+ * @brief Maps handles to the table and row the entity currently lives in
+ * @details tables use swap-remove, the moved entity is updated by relocate(),
+ * so insertion, removal and lookup are all O(1)
+ */
+class SlotMap {
+public:
+    /**
+     * @brief Location of an entity
+     */
+    struct Slot {
+        std::uint32_t generation = 1;
+        std::uint32_t row = 0;  // next free slot while the slot is not alive
+        std::uint8_t table = 0;
+        bool alive = false;
+    };
+
+    /**
+     * @brief Allocate a handle for the entity stored at the given row of the table
+     */
+    Handle insert(std::uint8_t table, std::uint32_t row) {
+        std::uint32_t index;
+        if (freeHead != noSlot) {
+            index = freeHead;
+            freeHead = slots[index].row;
+        } else {
+            index = static_cast<std::uint32_t>(slots.size());
+            slots.emplace_back();
+        }
+        Slot& slot = slots[index];
+        slot.table = table;
+        slot.row = row;
+        slot.alive = true;
+        ++liveCount;
+        return Handle{index, slot.generation};
+    }
+
+    /**
+     * @brief Resolve the handle
+     *
+     * @return slot of the entity or nullptr if the handle is stale or null
+     */
+    const Slot* find(Handle handle) const {
+        if (handle.index >= slots.size()) return nullptr;
+        const Slot& slot = slots[handle.index];
+        if (!slot.alive || slot.generation != handle.generation) return nullptr;
+        return &slot;
+    }
+
+    bool contains(Handle handle) const {
+        return find(handle) != nullptr;
+    }
+
+    /**
+     * @brief Update the row of a live entity after it was moved inside its table
+     */
+    void relocate(Handle handle, std::uint32_t row) {
+        slots[handle.index].row = row;
+    }
+
+    /**
+     * @brief Free the slot of a live entity, invalidating every copy of its handle
+     */
+    void erase(Handle handle) {
+        Slot& slot = slots[handle.index];
+        slot.alive = false;
+        ++slot.generation;
+        if (slot.generation == 0) slot.generation = 1;  // keep 0 reserved for null handles
+        slot.row = freeHead;
+        freeHead = handle.index;
+        --liveCount;
+    }
+
+    /**
+     * @brief Free all slots, old handles stay invalid
+     */
+    void clear() {
+        for (std::uint32_t i = 0; i < slots.size(); ++i) {
+            if (slots[i].alive) {
+                erase(Handle{i, slots[i].generation});
+            }
+        }
+    }
+
+    std::size_t size() const { return liveCount; }
+    std::size_t allocatedBytes() const { return slots.capacity() * sizeof(Slot); }
+
+    /**
+     * @brief All slots and the head of the free list, e.g. to copy the map to another process
+     */
+    const std::vector<Slot>& allSlots() const { return slots; }
+    std::uint32_t firstFree() const { return freeHead; }
+
+    /**
+     * @brief Replace the map by slots taken from allSlots() and firstFree() of another map
+     */
+    void assign(const std::vector<Slot>& copied, std::uint32_t copiedFreeHead) {
+        slots = copied;
+        freeHead = copiedFreeHead;
+        liveCount = 0;
+        for (const Slot& slot : slots) {
+            liveCount += slot.alive ? 1 : 0;
+        }
+    }
+
+private:
+    static constexpr std::uint32_t noSlot = UINT32_MAX;
+    std::vector<Slot> slots;
+    std::uint32_t freeHead = noSlot;
+    std::size_t liveCount = 0;
+};
+
+#endif // SLOTMAP_H
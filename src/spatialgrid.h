@@ -0,0 +1,444 @@
+/**
+ * @file spatialgrid.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Uniform grids used to find obstacles and robots near a field of vision
+ */
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "arena.h"
+#include "geometry.h"
+
+/**
+ * @brief Cell layout shared by the grids
+ */
+struct GridLayout {
+    Box bounds{0, 0, 0, 0};
+    double cellSize = 64;
+    int columns = 1;
+    int rows = 1;
+
+    void reset(const Box& newBounds, double newCellSize) {
+        bounds = newBounds;
+        cellSize = newCellSize;
+        columns = std::max(1, static_cast<int>(std::ceil((bounds.maxX - bounds.minX) / cellSize)));
+        rows = std::max(1, static_cast<int>(std::ceil((bounds.maxY - bounds.minY) / cellSize)));
+    }
+
+    int column(double x) const {
+        return std::clamp(static_cast<int>(std::floor((x - bounds.minX) / cellSize)), 0, columns - 1);
+    }
+
+    int row(double y) const {
+        return std::clamp(static_cast<int>(std::floor((y - bounds.minY) / cellSize)), 0, rows - 1);
+    }
+
+    int cellCount() const { return columns * rows; }
+};
+
+/**
+ * @brief Cell size giving about one cell per object, but never smaller than a robot
+ */
+inline double adaptiveCellSize(const Box& bounds, std::size_t objects) {
+    double area = (bounds.maxX - bounds.minX) * (bounds.maxY - bounds.minY);
+    return std::max(64.0, std::sqrt(area / std::max<std::size_t>(objects, 1)));
+}
+
+/**
+ * @brief Z-order (Morton) key of the point, points close in space get close keys
+ * @details coordinates are quantized to 16 bits inside the bounds and their bits interleaved
+ */
+inline std::uint32_t mortonKey(const Box& bounds, double x, double y) {
+    auto quantize = [](double value, double min, double max) {
+        double scaled = max > min ? (value - min) / (max - min) * 65535.0 : 0.0;
+        return static_cast<std::uint32_t>(std::clamp(scaled, 0.0, 65535.0));
+    };
+    auto spread = [](std::uint32_t v) {
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(quantize(x, bounds.minX, bounds.maxX)) | (spread(quantize(y, bounds.minY, bounds.maxY)) << 1);
+}
+
+/**
+ * @class ObstacleGrid
+ * @brief Grid of obstacle rows, an obstacle is listed in every cell it overlaps
+ * @details cells are stored as one offset array and one entry array, obstacles
+ * are static, so the grid is rebuilt in one pass when they change
+ */
+class ObstacleGrid {
+public:
+    /**
+     * @brief Rebuild the grid from scratch
+     *
+     * @param rows rows of the obstacles to list
+     * @param boxOf boxOf(row) returns the box of the obstacle at the row
+     */
+    template <typename F>
+    void build(const Box& bounds, const std::vector<std::uint32_t>& rows, F boxOf) {
+        layout.reset(bounds, adaptiveCellSize(bounds, rows.size()));
+        cellStart.assign(layout.cellCount() + 1, 0);
+        for (std::uint32_t row : rows) {
+            forCells(boxOf(row), [&](int cell) { ++cellStart[cell + 1]; });
+        }
+        for (int i = 0; i < layout.cellCount(); ++i) {
+            cellStart[i + 1] += cellStart[i];
+        }
+        entries.resize(cellStart.back());
+        std::vector<std::uint32_t> cursor(cellStart.begin(), cellStart.end() - 1);
+        for (std::uint32_t row : rows) {
+            forCells(boxOf(row), [&](int cell) { entries[cursor[cell]++] = row; });
+        }
+    }
+
+    /**
+     * @brief Call f(row) for obstacles in cells overlapping the box until f returns true
+     *
+     * @return true if f returned true
+     */
+    template <typename F>
+    bool query(const Box& box, F f) const {
+        for (int r = layout.row(box.minY); r <= layout.row(box.maxY); ++r) {
+            for (int c = layout.column(box.minX); c <= layout.column(box.maxX); ++c) {
+                int cell = r * layout.columns + c;
+                for (std::uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+                    if (f(entries[i])) return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    std::size_t allocatedBytes() const {
+        return (cellStart.capacity() + entries.capacity()) * sizeof(std::uint32_t);
+    }
+
+private:
+    GridLayout layout;
+    std::vector<std::uint32_t> cellStart{0, 0};
+    std::vector<std::uint32_t> entries;
+
+    template <typename F>
+    void forCells(const Box& box, F f) const {
+        for (int r = layout.row(box.minY); r <= layout.row(box.maxY); ++r) {
+            for (int c = layout.column(box.minX); c <= layout.column(box.maxX); ++c) {
+                f(r * layout.columns + c);
+            }
+        }
+    }
+};
+
+/**
+ * @brief Largest row of a table RobotBins can hold, the World refuses robots beyond it
+ */
+constexpr std::uint32_t maxBinnedRow = (1u << 24) - 1;
+
+/**
+ * @class RobotBins
+ * @brief Robots binned by the cell of their center, rebuilt every tick in the frame arena
+ * @details entries are (table, row) pairs packed as table << 24 | row with row <= maxBinnedRow,
+ * robots keep moving while the tick runs, so queries are widened by the travel margin
+ */
+class RobotBins {
+public:
+    /**
+     * @brief Start a rebuild for the given number of robots
+     */
+    void begin(const Box& bounds, double cellSize, std::size_t robots, FrameArena& arena) {
+        layout.reset(bounds, cellSize);
+        cellStart = arena.allocate<std::uint32_t>(layout.cellCount() + 1);
+        entries = arena.allocate<std::uint32_t>(robots);
+        std::fill(cellStart, cellStart + layout.cellCount() + 1, 0u);
+    }
+
+    void count(double x, double y) {
+        ++cellStart[cellOf(x, y) + 1];
+    }
+
+    /**
+     * @brief Turn counts into offsets, must be called after all count() calls
+     */
+    void prefixSum() {
+        for (int i = 0; i < layout.cellCount(); ++i) {
+            cellStart[i + 1] += cellStart[i];
+        }
+    }
+
+    /**
+     * @brief Place robot, called after prefixSum()
+     * @details uses the start of the cell as the cursor, finish() restores the offsets
+     */
+    void place(double x, double y, std::uint8_t table, std::uint32_t row) {
+        int cell = cellOf(x, y);
+        entries[cellStart[cell]++] = (std::uint32_t(table) << 24) | row;
+    }
+
+    void finish() {
+        for (int i = layout.cellCount(); i > 0; --i) {
+            cellStart[i] = cellStart[i - 1];
+        }
+        cellStart[0] = 0;
+        valid = true;
+    }
+
+    void invalidate() { valid = false; }
+    bool isValid() const { return valid; }
+
+    /**
+     * @brief Mean distance in rows between robots of the same table binned to the same cell
+     * @details about 1 when the tables are in spatial order, it grows as robots wander
+     */
+    double meanRowGap() const {
+        std::uint64_t gaps = 0;
+        std::uint64_t pairs = 0;
+        addRowGaps(gaps, pairs);
+        return pairs > 0 ? double(gaps) / pairs : 0.0;
+    }
+
+    /**
+     * @brief Add the row gaps and the number of pairs of meanRowGap() to the sums
+     */
+    void addRowGaps(std::uint64_t& gaps, std::uint64_t& pairs) const {
+        for (int cell = 0; cell < layout.cellCount(); ++cell) {
+            for (std::uint32_t i = cellStart[cell] + 1; i < cellStart[cell + 1]; ++i) {
+                if ((entries[i] >> 24) == (entries[i - 1] >> 24)) {
+                    gaps += (entries[i] & 0xFFFFFF) - (entries[i - 1] & 0xFFFFFF);  // placed in row order
+                    ++pairs;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Call f(table, row) for robots binned in cells overlapping the box until f returns true
+     */
+    template <typename F>
+    bool query(const Box& box, F f) const {
+        for (int r = layout.row(box.minY); r <= layout.row(box.maxY); ++r) {
+            for (int c = layout.column(box.minX); c <= layout.column(box.maxX); ++c) {
+                int cell = r * layout.columns + c;
+                for (std::uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+                    if (f(std::uint8_t(entries[i] >> 24), entries[i] & 0xFFFFFF)) return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    GridLayout layout;
+    std::uint32_t* cellStart = nullptr;
+    std::uint32_t* entries = nullptr;
+    bool valid = false;
+
+    int cellOf(double x, double y) const {
+        return layout.row(y) * layout.columns + layout.column(x);
+    }
+};
+
+/**
+ * @brief Side of the square chunks large worlds are split into
+ * @details the default 1500x600 scene fits into one chunk
+ */
+constexpr double chunkSize = 2048;
+
+/**
+ * @brief Chunk layout of the world, chunks on the right and bottom edge are cut by the bounds
+ */
+struct ChunkLayout : GridLayout {
+    void reset(const Box& worldBounds) { GridLayout::reset(worldBounds, chunkSize); }
+
+    Box chunkBounds(int chunk) const {
+        int c = chunk % columns;
+        int r = chunk / columns;
+        return Box{bounds.minX + c * cellSize, bounds.minY + r * cellSize,
+                   std::min(bounds.maxX, bounds.minX + (c + 1) * cellSize),
+                   std::min(bounds.maxY, bounds.minY + (r + 1) * cellSize)};
+    }
+
+    int chunkOf(double x, double y) const { return row(y) * columns + column(x); }
+
+    /**
+     * @brief Call f(chunk) for chunks overlapping the box until f returns true
+     */
+    template <typename F>
+    bool anyChunk(const Box& box, F f) const {
+        for (int r = row(box.minY); r <= row(box.maxY); ++r) {
+            for (int c = column(box.minX); c <= column(box.maxX); ++c) {
+                if (f(r * columns + c)) return true;
+            }
+        }
+        return false;
+    }
+};
+
+/**
+ * @class ChunkedObstacleGrid
+ * @brief Obstacle grids of the chunks, an obstacle is listed in every chunk it overlaps
+ * @details every chunk sizes its cells by its own obstacle count, so dense areas of a large
+ * sparse world keep small cells. The grids are immutable once built, the world builds new
+ * ones before the next tick when its obstacles change
+ */
+class ChunkedObstacleGrid {
+public:
+    /**
+     * @brief Rebuild the grids from scratch
+     *
+     * @param count number of obstacles
+     * @param boxOf boxOf(row) returns the box of the obstacle at the row
+     */
+    template <typename F>
+    void build(const Box& bounds, std::size_t count, F boxOf) {
+        layout.reset(bounds);
+        std::vector<std::vector<std::uint32_t>> rows(layout.cellCount());
+        for (std::uint32_t row = 0; row < count; ++row) {
+            layout.anyChunk(boxOf(row), [&](int chunk) {
+                rows[chunk].push_back(row);
+                return false;
+            });
+        }
+        chunks.assign(layout.cellCount(), ObstacleGrid{});
+        for (int chunk = 0; chunk < layout.cellCount(); ++chunk) {
+            chunks[chunk].build(layout.chunkBounds(chunk), rows[chunk], boxOf);
+        }
+    }
+
+    /**
+     * @brief Call f(row) for obstacles near the box until f returns true
+     * @details the grids must be built from the current obstacles, an obstacle crossing chunks may be passed more than once
+     *
+     * @return true if f returned true
+     */
+    template <typename F>
+    bool query(const Box& box, F f) const {
+        return layout.anyChunk(box, [&](int chunk) { return chunks[chunk].query(box, f); });
+    }
+
+    std::size_t allocatedBytes() const {
+        std::size_t bytes = chunks.capacity() * sizeof(ObstacleGrid);
+        for (const ObstacleGrid& grid : chunks) {
+            bytes += grid.allocatedBytes();
+        }
+        return bytes;
+    }
+
+private:
+    ChunkLayout layout;
+    std::vector<ObstacleGrid> chunks{1};
+};
+
+/**
+ * @class ChunkedRobotBins
+ * @brief Robot bins of the chunks holding robots, chunks without robots are skipped
+ * @details a rebuild tallies the robots per chunk first, then bins every occupied chunk
+ * in the arena with cells sized by its own robot count, see RobotBins. The chunk of every
+ * robot is kept from tally(), so count() and place() must visit the robots in the same order
+ */
+class ChunkedRobotBins {
+public:
+    /**
+     * @brief Start a rebuild, followed by tally() of every robot
+     */
+    void begin(const Box& bounds, std::size_t robots, FrameArena& arena) {
+        layout.reset(bounds);
+        if (chunks.size() != static_cast<std::size_t>(layout.cellCount())) {
+            chunks.assign(layout.cellCount(), RobotBins{});
+        }
+        tallies = arena.allocate<std::uint32_t>(layout.cellCount());
+        std::fill(tallies, tallies + layout.cellCount(), 0u);
+        visits = arena.allocate<std::uint32_t>(robots);
+        visitCount = 0;
+        valid = false;
+    }
+
+    void tally(double x, double y) {
+        int chunk = layout.chunkOf(x, y);
+        ++tallies[chunk];
+        visits[visitCount++] = chunk;
+    }
+
+    /**
+     * @brief Start the bins of the occupied chunks, followed by count() of every robot
+     */
+    void prepare(FrameArena& arena) {
+        active = arena.allocate<std::uint32_t>(layout.cellCount());
+        activeCount = 0;
+        for (int chunk = 0; chunk < layout.cellCount(); ++chunk) {
+            chunks[chunk].invalidate();
+            if (tallies[chunk] == 0) continue;
+            Box bounds = layout.chunkBounds(chunk);
+            chunks[chunk].begin(bounds, adaptiveCellSize(bounds, tallies[chunk]), tallies[chunk], arena);
+            active[activeCount++] = chunk;
+        }
+        visitCount = 0;
+    }
+
+    void count(double x, double y) {
+        chunks[visits[visitCount++]].count(x, y);
+    }
+
+    void prefixSum() {
+        for (std::size_t i = 0; i < activeCount; ++i) {
+            chunks[active[i]].prefixSum();
+        }
+        visitCount = 0;
+    }
+
+    void place(double x, double y, std::uint8_t table, std::uint32_t row) {
+        chunks[visits[visitCount++]].place(x, y, table, row);
+    }
+
+    void finish() {
+        for (std::size_t i = 0; i < activeCount; ++i) {
+            chunks[active[i]].finish();
+        }
+        valid = true;
+    }
+
+    void invalidate() { valid = false; }
+    bool isValid() const { return valid; }
+    std::size_t activeChunks() const { return activeCount; }
+    std::size_t chunkCount() const { return chunks.size(); }
+
+    /**
+     * @brief Mean row gap over all occupied chunks, see RobotBins::meanRowGap()
+     */
+    double meanRowGap() const {
+        std::uint64_t gaps = 0;
+        std::uint64_t pairs = 0;
+        for (std::size_t i = 0; i < activeCount; ++i) {
+            chunks[active[i]].addRowGaps(gaps, pairs);
+        }
+        return pairs > 0 ? double(gaps) / pairs : 0.0;
+    }
+
+    /**
+     * @brief Call f(table, row) for robots binned near the box until f returns true
+     */
+    template <typename F>
+    bool query(const Box& box, F f) const {
+        return layout.anyChunk(box, [&](int chunk) {
+            return chunks[chunk].isValid() && chunks[chunk].query(box, f);
+        });
+    }
+
+private:
+    ChunkLayout layout;
+    std::vector<RobotBins> chunks;
+    std::uint32_t* tallies = nullptr;
+    std::uint32_t* visits = nullptr;  // chunk of every robot in the order of tally()
+    std::size_t visitCount = 0;
+    std::uint32_t* active = nullptr;  // occupied chunks
+    std::size_t activeCount = 0;
+    bool valid = false;
+};
+
+#endif // SPATIALGRID_H
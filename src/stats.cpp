@@ -0,0 +1,137 @@
+/**
+ * @file stats.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Streaming statistics whose memory does not grow with the number of samples
+ */
+#include "stats.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Account one value
+ */
+void RunningStats::add(double value) {
+    ++samples;
+    if (samples == 1) {
+        smallest = largest = value;
+    }
+    smallest = std::min(smallest, value);
+    largest = std::max(largest, value);
+    double delta = value - average;
+    average += delta / samples;
+    squares += delta * (value - average);
+}
+
+/**
+ * @brief Sample standard deviation
+ */
+double RunningStats::stddev() const {
+    return std::sqrt(variance());
+}
+
+/**
+ * @param quantile quantile to estimate in (0, 1), e.g. 0.9 for the 90th percentile
+ */
+QuantileEstimator::QuantileEstimator(double quantile) : quantile(quantile) {
+    double growth[5] = {0, quantile / 2, quantile, (1 + quantile) / 2, 1};
+    for (int i = 0; i < 5; ++i) {
+        increments[i] = growth[i];
+    }
+}
+
+/**
+ * @brief Account one value
+ */
+void QuantileEstimator::add(double value) {
+    if (samples < exactSamples) {
+        exact.push_back(value);
+        ++samples;
+        return;
+    }
+    if (!exact.empty()) {
+        placeMarkers();
+    }
+    ++samples;
+
+    // cell of the value, the extreme markers follow the minimum and the maximum
+    int cell;
+    if (value < heights[0]) {
+        heights[0] = value;
+        cell = 0;
+    } else if (value >= heights[4]) {
+        heights[4] = std::max(heights[4], value);
+        cell = 3;
+    } else {
+        cell = 0;
+        while (cell < 3 && value >= heights[cell + 1]) {
+            ++cell;
+        }
+    }
+    for (int i = cell + 1; i < 5; ++i) {
+        positions[i] += 1;
+    }
+    for (int i = 0; i < 5; ++i) {
+        desired[i] += increments[i];
+    }
+
+    // move the inner markers towards their desired positions by one
+    for (int i = 1; i < 4; ++i) {
+        double offset = desired[i] - positions[i];
+        if ((offset >= 1 && positions[i + 1] - positions[i] > 1) || (offset <= -1 && positions[i - 1] - positions[i] < -1)) {
+            double direction = offset >= 1 ? 1 : -1;
+            double height = parabolic(i, direction);
+            if (height <= heights[i - 1] || height >= heights[i + 1]) {
+                height = linear(i, direction);
+            }
+            heights[i] = height;
+            positions[i] += direction;
+        }
+    }
+}
+
+/**
+ * @brief Put the markers on the kept values at their desired positions and drop the values
+ */
+void QuantileEstimator::placeMarkers() {
+    std::sort(exact.begin(), exact.end());
+    double count = static_cast<double>(exact.size());
+    for (int i = 0; i < 5; ++i) {
+        desired[i] = 1 + (count - 1) * increments[i];
+        // the markers must stay on distinct ranks, also for quantiles close to 0 or 1
+        double lowest = i > 0 ? positions[i - 1] + 1 : 1;
+        positions[i] = std::min(std::max(std::round(desired[i]), lowest), count - (4 - i));
+        heights[i] = exact[static_cast<std::size_t>(positions[i]) - 1];
+    }
+    exact.clear();
+    exact.shrink_to_fit();
+}
+
+/**
+ * @brief Current estimate, exact while there are at most exactSamples values
+ */
+double QuantileEstimator::value() const {
+    if (samples == 0) {
+        return 0;
+    }
+    if (samples <= exactSamples) {
+        // nearest rank of the values kept so far
+        std::vector<double> sorted = exact;
+        std::size_t rank = static_cast<std::size_t>(std::ceil(quantile * samples));
+        rank = rank > 0 ? rank - 1 : 0;
+        std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank), sorted.end());
+        return sorted[rank];
+    }
+    return heights[2];
+}
+
+double QuantileEstimator::parabolic(int i, double d) const {
+    double n0 = positions[i - 1], n1 = positions[i], n2 = positions[i + 1];
+    return heights[i] + d / (n2 - n0) * ((n1 - n0 + d) * (heights[i + 1] - heights[i]) / (n2 - n1)
+                                         + (n2 - n1 - d) * (heights[i] - heights[i - 1]) / (n1 - n0));
+}
+
+double QuantileEstimator::linear(int i, double d) const {
+    int j = i + static_cast<int>(d);
+    return heights[i] + d * (heights[j] - heights[i]) / (positions[j] - positions[i]);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file stats.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Streaming statistics whose memory does not grow with the number of samples
+ */
+#ifndef STATS_H
+#define STATS_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class RunningStats
+ * @brief Count, mean, variance and range of a stream of values (Welford's algorithm)
+ */
+class RunningStats {
+public:
+    void add(double value);
+
+    std::size_t count() const { return samples; }
+    double mean() const { return average; }
+    double variance() const { return samples > 1 ? squares / (samples - 1) : 0.0; }
+    double stddev() const;
+    double min() const { return smallest; }
+    double max() const { return largest; }
+
+private:
+    std::size_t samples = 0;
+    double average = 0;
+    double squares = 0;  // sum of squared differences from the mean
+    double smallest = 0;
+    double largest = 0;
+};
+
+/**
+ * @class QuantileEstimator
+ * @brief Estimate of one quantile of a stream of values in constant memory (P-square algorithm)
+ * @details the first exactSamples values are kept and the quantile is exact for them, for
+ * fewer values the estimate is too coarse. Then five markers placed on the kept values follow
+ * the minimum, the quantile, the maximum and two points between, their heights are adjusted
+ * by a piecewise parabolic fit as the values arrive
+ */
+class QuantileEstimator {
+public:
+    static constexpr std::size_t exactSamples = 500;
+
+    explicit QuantileEstimator(double quantile);
+
+    void add(double value);
+    double value() const;
+
+private:
+    double quantile;
+    std::size_t samples = 0;
+    std::vector<double> exact;  // the values while there are at most exactSamples
+    double heights[5] = {};
+    double positions[5] = {};  // actual marker positions, 1-based
+    double desired[5] = {};  // desired marker positions
+    double increments[5] = {};  // growth of the desired positions per value
+
+    void placeMarkers();
+    double parabolic(int marker, double direction) const;
+    double linear(int marker, double direction) const;
+};
+
+#endif // STATS_H
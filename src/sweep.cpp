@@ -0,0 +1,228 @@
+/**
+ * @file sweep.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Headless sweep over the parameters of the autonomous robots of a scene
+ * @details usage: simulation --sweep [--angle RANGE] [--radius RANGE] [--speed RANGE] [--ticks T]
+ * [--threads N] [--csv results.csv] scene.txt
+ *
+ * A range is a single value, a list a,b,c or from:to:step. Every combination sets the
+ * avoidanceAngle, detectionRadius and speed of all autonomous robots and sources of the
+ * scene, the combinations run side by side as worlds of one WorldHost and a table of
+ * the results is printed:
+ * stuck time, coverage and collisions (see MetricsProbe) and the ticks per second
+ */
+#include "sweep.h"
+#include "metrics.h"
+#include "scene.h"
+#include "worldhost.h"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Options of the sweep
+ */
+struct SweepOptions {
+    std::vector<double> angles;  // empty keeps the values of the scene
+    std::vector<double> radii;
+    std::vector<double> speeds;
+    long ticks = 1000;
+    unsigned threads = std::thread::hardware_concurrency();
+    std::string csv;
+    std::string scene;
+};
+
+/**
+ * @brief One combination of the parameters and its results
+ */
+struct SweepResult {
+    double angle, radius, speed;  // NAN keeps the value of the scene
+    RunMetrics metrics;
+    double ticksPerSecond = 0;  // of the engine alone, without the metrics
+    std::uint64_t hash = 0;
+};
+
+/**
+ * @brief Parse a range: a value, a list a,b,c or from:to:step
+ *
+ * @return false on invalid syntax
+ */
+static bool parseRange(const std::string& text, std::vector<double>& values) {
+    values.clear();
+    char* end = nullptr;
+    if (text.find(':') != std::string::npos) {
+        double from = std::strtod(text.c_str(), &end);
+        if (*end != ':') return false;
+        double to = std::strtod(end + 1, &end);
+        if (*end != ':') return false;
+        double step = std::strtod(end + 1, &end);
+        if (*end != '\0' || step <= 0 || to < from) return false;
+        for (long i = 0; from + i * step <= to + 1e-9; ++i) {
+            values.push_back(from + i * step);
+        }
+        return true;
+    }
+    const char* begin = text.c_str();
+    while (*begin) {
+        values.push_back(std::strtod(begin, &end));
+        if (end == begin || (*end != ',' && *end != '\0')) return false;
+        begin = *end == ',' ? end + 1 : end;
+    }
+    return !values.empty();
+}
+
+/**
+ * @brief Parse command line arguments following --sweep
+ *
+ * @return false on invalid arguments
+ */
+static bool parseOptions(int argc, char *argv[], SweepOptions& options) {
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--angle" && i + 1 < argc) {
+            if (!parseRange(argv[++i], options.angles)) return false;
+        } else if (arg == "--radius" && i + 1 < argc) {
+            if (!parseRange(argv[++i], options.radii)) return false;
+        } else if (arg == "--speed" && i + 1 < argc) {
+            if (!parseRange(argv[++i], options.speeds)) return false;
+        } else if ((arg == "--ticks" || arg == "--threads") && i + 1 < argc) {
+            long value = std::strtol(argv[++i], nullptr, 10);
+            if (value <= 0) return false;
+            if (arg == "--ticks") options.ticks = value;
+            else options.threads = static_cast<unsigned>(value);
+        } else if (arg == "--csv" && i + 1 < argc) {
+            options.csv = argv[++i];
+        } else if (!arg.empty() && arg[0] != '-' && options.scene.empty()) {
+            options.scene = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.scene.empty();
+}
+
+/**
+ * @brief Copy of the scene with the parameters of the combination set on every autonomous robot and source
+ */
+static Scene applyParameters(const Scene& base, const SweepResult& combination) {
+    Scene scene = base;
+    for (SceneObject& object : scene.objects) {
+        if (object.type != "AutonomousRobot" && object.type != "Source") continue;
+        if (!std::isnan(combination.angle)) object.attributes["avoidanceAngle"] = std::to_string(combination.angle);
+        if (!std::isnan(combination.radius)) object.attributes["detectionRadius"] = std::to_string(combination.radius);
+        if (!std::isnan(combination.speed)) object.attributes["speed"] = std::to_string(std::lround(combination.speed));
+    }
+    return scene;
+}
+
+/**
+ * @brief Print the results as an aligned table and optionally write them as CSV
+ *
+ * @return false if the CSV file can not be written
+ */
+static bool writeResults(const std::vector<SweepResult>& results, const std::string& csv) {
+    auto value = [](double v) {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%g", v);
+        return std::isnan(v) ? std::string("scene") : std::string(text);
+    };
+    std::printf("%8s %8s %8s %8s %14s %9s %11s %12s %16s\n",
+                "angle", "radius", "speed", "stuck%", "longest stuck", "coverage%", "collisions", "ticks/sec", "hash");
+    std::FILE* file = csv.empty() ? nullptr : std::fopen(csv.c_str(), "w");
+    if (!csv.empty() && !file) {
+        std::fprintf(stderr, "Cannot open file for writing: %s\n", csv.c_str());
+        return false;
+    }
+    if (file) {
+        std::fprintf(file, "avoidanceAngle,detectionRadius,speed,stuckPercent,longestStuck,coveragePercent,collisions,ticksPerSecond,hash\n");
+    }
+    for (const SweepResult& result : results) {
+        const RunMetrics& metrics = result.metrics;
+        std::printf("%8s %8s %8s %8.2f %14ld %9.2f %11" PRIu64 " %12.1f %016" PRIx64 "\n",
+                    value(result.angle).c_str(), value(result.radius).c_str(), value(result.speed).c_str(),
+                    metrics.stuckPercent(), metrics.longestStuck, metrics.coveragePercent(), metrics.collisions, result.ticksPerSecond, result.hash);
+        if (file) {
+            std::fprintf(file, "%s,%s,%s,%.4f,%ld,%.4f,%" PRIu64 ",%.1f,%016" PRIx64 "\n",
+                         value(result.angle).c_str(), value(result.radius).c_str(), value(result.speed).c_str(),
+                         metrics.stuckPercent(), metrics.longestStuck, metrics.coveragePercent(), metrics.collisions, result.ticksPerSecond, result.hash);
+        }
+    }
+    if (file) {
+        std::fclose(file);
+    }
+    return true;
+}
+
+/**
+ * @brief Entry point of the sweep
+ *
+ * @param argc number of arguments following --sweep
+ * @param argv arguments following --sweep
+ * @return int exit code
+ */
+int runSweep(int argc, char *argv[]) {
+    SweepOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: simulation --sweep [--angle RANGE] [--radius RANGE] [--speed RANGE] [--ticks T] "
+                             "[--threads N] [--csv results.csv] scene.txt, RANGE is v, a,b,c or from:to:step\n");
+        return 2;
+    }
+    Scene base;
+    if (!loadScene(options.scene, base)) {
+        std::fprintf(stderr, "Cannot open file for reading: %s\n", options.scene.c_str());
+        return 2;
+    }
+
+    // an empty range keeps the value of the scene
+    std::vector<double> angles = options.angles.empty() ? std::vector<double>{NAN} : options.angles;
+    std::vector<double> radii = options.radii.empty() ? std::vector<double>{NAN} : options.radii;
+    std::vector<double> speeds = options.speeds.empty() ? std::vector<double>{NAN} : options.speeds;
+    std::vector<SweepResult> results;
+    WorkerPool pool(options.threads);
+    WorldHost host(pool);
+    for (double angle : angles) {
+        for (double radius : radii) {
+            for (double speed : speeds) {
+                SweepResult combination{};
+                combination.angle = angle;
+                combination.radius = radius;
+                combination.speed = speed;
+                results.push_back(combination);
+                auto world = std::make_unique<World>();
+                populateWorld(*world, applyParameters(base, combination));
+                host.add(std::move(world));
+            }
+        }
+    }
+    std::printf("%zu combinations of %s on %u threads, %ld ticks each\n",
+                results.size(), options.scene.c_str(), pool.size(), options.ticks);
+    std::fflush(stdout);
+
+    auto start = std::chrono::steady_clock::now();
+    host.forEach([&](std::size_t index, World& world) {
+        SweepResult& result = results[index];
+        MetricsProbe probe(world);
+        auto begin = std::chrono::steady_clock::now();
+        double stepping = 0;
+        for (long tick = 0; tick < options.ticks; ++tick) {
+            world.step();
+            auto stepped = std::chrono::steady_clock::now();
+            stepping += std::chrono::duration<double>(stepped - begin).count();
+            probe.sample(world, result.metrics);
+            begin = std::chrono::steady_clock::now();
+        }
+        result.ticksPerSecond = stepping > 0 ? options.ticks / stepping : 0;
+        result.hash = world.stateHash();
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool ok = writeResults(results, options.csv);
+    std::printf("sweep took %.3f s\n", seconds);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,12 @@
+/**
+ * @file sweep.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Headless sweep over the parameters of the autonomous robots of a scene
+ */
+#ifndef SWEEP_H
+#define SWEEP_H
+
+int runSweep(int argc, char *argv[]);
+
+#endif // SWEEP_H
@@ -0,0 +1,71 @@
+/**
+ * @file threadpool.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Fixed set of worker threads running data parallel loops
+ */
+#include "threadpool.h"
+
+WorkerPool::WorkerPool(unsigned threads) {
+    for (unsigned chunk = 1; chunk < threads; ++chunk) {
+        workers.emplace_back(&WorkerPool::work, this, chunk);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Run the task on every chunk, the caller takes chunk 0
+ */
+void WorkerPool::run(Task newTask, void* newContext) {
+    if (workers.empty()) {
+        newTask(newContext, 0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = newTask;
+        context = newContext;
+        pending = static_cast<unsigned>(workers.size());
+        ++generation;
+    }
+    wake.notify_all();
+    newTask(newContext, 0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return pending == 0; });
+}
+
+/**
+ * @brief Loop of a worker thread, runs its chunk of every task
+ */
+void WorkerPool::work(unsigned chunk) {
+    unsigned long seen = 0;
+    while (true) {
+        Task current;
+        void* currentContext;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            current = task;
+            currentContext = context;
+        }
+        current(currentContext, chunk);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --pending;
+        }
+        done.notify_one();
+    }
+}
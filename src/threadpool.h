@@ -0,0 +1,71 @@
+/**
+ * @file threadpool.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Fixed set of worker threads running data parallel loops
+ */
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkerPool
+ * @brief Runs one loop at a time split into one contiguous chunk per thread
+ * @details the calling thread works on the first chunk, so a pool of size 1
+ * has no worker threads and runs everything inline. Tasks are passed as a
+ * function pointer and a context, running a loop does not allocate
+ */
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned threads = std::thread::hardware_concurrency());
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Number of threads running a loop, including the caller
+     */
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    /**
+     * @brief Call f(begin, end, chunk) for size() contiguous chunks of [0, count) and wait for all of them
+     */
+    template <typename F>
+    void parallelFor(std::size_t count, F f) {
+        struct Loop {
+            F* f;
+            std::size_t count;
+            unsigned chunks;
+        } loop{&f, count, size()};
+        run([](void* context, unsigned chunk) {
+            Loop& loop = *static_cast<Loop*>(context);
+            std::size_t begin = loop.count * chunk / loop.chunks;
+            std::size_t end = loop.count * (chunk + 1) / loop.chunks;
+            (*loop.f)(begin, end, chunk);
+        }, &loop);
+    }
+
+private:
+    using Task = void (*)(void* context, unsigned chunk);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    Task task = nullptr;
+    void* context = nullptr;
+    unsigned long generation = 0;  // bumped for every loop
+    unsigned pending = 0;  // workers still running the current loop
+    bool stopping = false;
+
+    void run(Task newTask, void* newContext);
+    void work(unsigned chunk);
+};
+
+#endif // THREADPOOL_H
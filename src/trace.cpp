@@ -0,0 +1,239 @@
+/**
+ * @file trace.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Recording of world state hashes and locating the first divergence of two recordings
+ * @details usage:
+ *   simulation --trace [--ticks N] [--every N] [--threads N] [--fixed] [--sense-interval N] [--kinetic]
+ *       scene.txt out.trace
+ *   simulation --trace-diff a.trace b.trace
+ *
+ * The trace is text: a "trace" header line, then for every recorded tick a line
+ * "tick T hash H entities N" followed by N lines "table index generation hash x y orientation".
+ */
+#include "trace.h"
+#include "scene.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+void TraceWriter::writeHeader(const std::string& scene, long every) {
+    std::fprintf(file, "trace %s every %ld\n", scene.c_str(), every);
+}
+
+/**
+ * @brief Write the world hash and all entities of the tick
+ */
+void TraceWriter::writeTick(long tick, const World& world) {
+    states.resize(world.entityCount());
+    pool.parallelFor(states.size(), [&](std::size_t begin, std::size_t end, unsigned) {
+        for (std::size_t i = begin; i < end; ++i) {
+            states[i] = world.entityState(i);
+        }
+    });
+    std::sort(states.begin(), states.end(), [](const EntityState& a, const EntityState& b) {
+        return a.handle.index < b.handle.index;
+    });
+
+    std::uint64_t hash = 0;
+    for (const EntityState& state : states) {
+        hash += state.hash;
+    }
+    std::fprintf(file, "tick %ld hash %016" PRIx64 " entities %zu\n", tick, hash, states.size());
+    for (const EntityState& state : states) {
+        std::fprintf(file, "%u %u %u %016" PRIx64 " %.9g %.9g %u\n", unsigned(state.table), state.handle.index,
+                     state.handle.generation, state.hash, state.x, state.y, unsigned(state.orientation));
+    }
+}
+
+/**
+ * @brief Run the scene headless and record its trace
+ *
+ * @param argc number of arguments following --trace
+ * @param argv arguments following --trace
+ * @return int exit code
+ */
+int runTrace(int argc, char *argv[]) {
+    long ticks = 1000;
+    long every = 1;
+    unsigned threads = std::thread::hardware_concurrency();
+    std::vector<std::string> files;
+    bool valid = true;
+    bool fixedPoint = false;
+    long senseInterval = 1;
+    bool kinetic = false;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--fixed") {
+            fixedPoint = true;
+        } else if (arg == "--kinetic") {
+            kinetic = true;
+        } else if ((arg == "--ticks" || arg == "--every" || arg == "--threads" || arg == "--sense-interval")
+                   && i + 1 < argc) {
+            long value = std::strtol(argv[++i], nullptr, 10);
+            valid = valid && value > 0;
+            if (arg == "--ticks") ticks = value;
+            else if (arg == "--every") every = value;
+            else if (arg == "--sense-interval") senseInterval = value;
+            else threads = static_cast<unsigned>(value);
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (!valid || files.size() != 2) {
+        std::fprintf(stderr, "usage: simulation --trace [--ticks N] [--every N] [--threads N] [--fixed] "
+                             "[--sense-interval N] [--kinetic] scene.txt out.trace\n");
+        return 2;
+    }
+
+    Scene scene;
+    if (!loadScene(files[0], scene)) {
+        std::fprintf(stderr, "Cannot open file for reading: %s\n", files[0].c_str());
+        return 1;
+    }
+    std::FILE* out = std::fopen(files[1].c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "Cannot open file for writing: %s\n", files[1].c_str());
+        return 1;
+    }
+
+    World world;
+    populateWorld(world, scene);
+    if (fixedPoint) {
+        world.setFixedPoint(true);
+    }
+    if (senseInterval > 1) {
+        world.setSenseInterval(RobotKind::Autonomous, static_cast<int>(senseInterval));
+        world.setSenseInterval(RobotKind::Remote, static_cast<int>(senseInterval));
+    }
+    if (kinetic) {
+        world.setKineticScheduling(true);
+    }
+    WorkerPool pool(threads);
+    TraceWriter writer(out, pool);
+    writer.writeHeader(files[0], every);
+    writer.writeTick(0, world);
+    for (long tick = 1; tick <= ticks; ++tick) {
+        world.step();
+        if (tick % every == 0) {
+            writer.writeTick(tick, world);
+        }
+    }
+    std::fclose(out);
+    return 0;
+}
+
+/**
+ * @brief One recorded tick of a trace
+ */
+struct TraceTick {
+    long tick = -1;
+    std::string hash;
+    std::vector<std::string> entities;  // entity lines ordered by handle
+};
+
+/**
+ * @brief Read the next recorded tick
+ *
+ * @return false at the end of the trace
+ */
+static bool readTick(std::istream& in, TraceTick& tick) {
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 5, "tick ") != 0) continue;
+        std::istringstream header(line);
+        std::string word;
+        std::size_t count = 0;
+        header >> word >> tick.tick >> word >> tick.hash >> word >> count;
+        tick.entities.resize(count);
+        for (std::string& entity : tick.entities) {
+            if (!std::getline(in, entity)) return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Handle index of an entity line, used to align the entities of two traces
+ */
+static unsigned long entityIndex(const std::string& line) {
+    std::istringstream in(line);
+    unsigned long table, index;
+    in >> table >> index;
+    return index;
+}
+
+/**
+ * @brief Print the first entity whose state differs between the two ticks
+ */
+static void reportEntity(const TraceTick& a, const TraceTick& b) {
+    std::size_t i = 0, j = 0;
+    while (i < a.entities.size() || j < b.entities.size()) {
+        if (j == b.entities.size() || (i < a.entities.size() && entityIndex(a.entities[i]) < entityIndex(b.entities[j]))) {
+            std::printf("  only in first:  %s\n", a.entities[i].c_str());
+            return;
+        }
+        if (i == a.entities.size() || entityIndex(b.entities[j]) < entityIndex(a.entities[i])) {
+            std::printf("  only in second: %s\n", b.entities[j].c_str());
+            return;
+        }
+        if (a.entities[i] != b.entities[j]) {
+            std::printf("  first divergent entity (table index generation hash x y orientation):\n");
+            std::printf("    first:  %s\n    second: %s\n", a.entities[i].c_str(), b.entities[j].c_str());
+            return;
+        }
+        ++i;
+        ++j;
+    }
+}
+
+/**
+ * @brief Compare two traces and report the first divergent tick and entity
+ *
+ * @param argc number of arguments following --trace-diff
+ * @param argv arguments following --trace-diff
+ * @return int 0 when the traces match, 1 when they diverge
+ */
+int runTraceDiff(int argc, char *argv[]) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: simulation --trace-diff a.trace b.trace\n");
+        return 2;
+    }
+    std::ifstream first(argv[0]);
+    std::ifstream second(argv[1]);
+    if (!first || !second) {
+        std::fprintf(stderr, "Cannot open file for reading: %s\n", !first ? argv[0] : argv[1]);
+        return 2;
+    }
+
+    TraceTick a, b;
+    long lastMatch = -1;
+    while (true) {
+        bool moreA = readTick(first, a);
+        bool moreB = readTick(second, b);
+        if (!moreA || !moreB) {
+            if (moreA != moreB) {
+                std::printf("traces match up to tick %ld, then %s ends\n", lastMatch, moreA ? "second" : "first");
+                return 1;
+            }
+            std::printf("traces match, last compared tick %ld\n", lastMatch);
+            return 0;
+        }
+        if (a.tick != b.tick) {
+            std::printf("traces record different ticks (%ld and %ld), use the same --every\n", a.tick, b.tick);
+            return 1;
+        }
+        if (a.hash != b.hash || a.entities != b.entities) {
+            std::printf("first divergence at tick %ld (last match at tick %ld)\n", a.tick, lastMatch);
+            std::printf("  hash %s vs %s\n", a.hash.c_str(), b.hash.c_str());
+            reportEntity(a, b);
+            return 1;
+        }
+        lastMatch = a.tick;
+    }
+}
@@ -0,0 +1,39 @@
+/**
+ * @file trace.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Recording of world state hashes and locating the first divergence of two recordings
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "world.h"
+
+class WorkerPool;
+
+/**
+ * @class TraceWriter
+ * @brief Writes the world hash and the state of every entity every N ticks
+ * @details entity hashes are computed on the worker pool, entities are written
+ * ordered by their handles, so traces of runs with different row orders compare equal
+ */
+class TraceWriter {
+public:
+    TraceWriter(std::FILE* file, WorkerPool& pool) : file(file), pool(pool) {}
+
+    void writeHeader(const std::string& scene, long every);
+    void writeTick(long tick, const World& world);
+
+private:
+    std::FILE* file;
+    WorkerPool& pool;
+    std::vector<EntityState> states;
+};
+
+int runTrace(int argc, char *argv[]);
+int runTraceDiff(int argc, char *argv[]);
+
+#endif // TRACE_H
@@ -0,0 +1,137 @@
+/**
+ * @file trig.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Table based trigonometry over whole degrees
+ */
+#ifndef TRIG_H
+#define TRIG_H
+
+#include <array>
+#include <cstdint>
+
+constexpr std::int32_t trigOne = 16384;  // 1.0 in the fixed point tables (Q14)
+
+/**
+ * @brief sin of 0..90 degrees in Q14, rounded to nearest
+ * @details written out instead of computed, so every compiler sees the same values
+ */
+constexpr std::int32_t quarterSine[91] = {
+    0, 286, 572, 857, 1143, 1428, 1713, 1997, 2280, 2563,
+    2845, 3126, 3406, 3686, 3964, 4240, 4516, 4790, 5063, 5334,
+    5604, 5872, 6138, 6402, 6664, 6924, 7182, 7438, 7692, 7943,
+    8192, 8438, 8682, 8923, 9162, 9397, 9630, 9860, 10087, 10311,
+    10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+    12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+    14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+    15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+    16384
+};
+
+constexpr std::int32_t tan30 = 9459;  // tan(30 degrees) in Q14, half angle of the field of vision
+
+/**
+ * @brief sin of whole degrees in Q14
+ */
+constexpr std::int32_t fixedSin(int degrees) {
+    degrees %= 360;
+    if (degrees < 0) degrees += 360;
+    if (degrees <= 90) return quarterSine[degrees];
+    if (degrees <= 180) return quarterSine[180 - degrees];
+    if (degrees <= 270) return -quarterSine[degrees - 180];
+    return -quarterSine[360 - degrees];
+}
+
+/**
+ * @brief cos of whole degrees in Q14
+ */
+constexpr std::int32_t fixedCos(int degrees) {
+    return fixedSin(degrees + 90);
+}
+
+/**
+ * @brief Direction of a heading, (cos, sin) of the angle
+ */
+struct UnitVector {
+    float x, y;
+};
+
+namespace trig_detail {
+
+constexpr double pi = 3.14159265358979323846;
+
+/**
+ * @brief Taylor series of sin, accurate to double precision for |x| <= pi/4
+ */
+constexpr double sinSeries(double x) {
+    double term = x;
+    double sum = x;
+    for (int n = 1; n <= 9; ++n) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * @brief Taylor series of cos, accurate to double precision for |x| <= pi/4
+ */
+constexpr double cosSeries(double x) {
+    double term = 1;
+    double sum = 1;
+    for (int n = 1; n <= 9; ++n) {
+        term *= -x * x / ((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * @brief Unit vector of whole degrees in [0, 360), reduced to an octant before the series
+ */
+constexpr UnitVector unitVectorOf(int degrees) {
+    int quadrant = degrees / 90;
+    int rest = degrees % 90;
+    double c = 0, s = 0;
+    if (rest <= 45) {
+        double angle = rest * pi / 180;
+        c = cosSeries(angle);
+        s = sinSeries(angle);
+    } else {
+        double angle = (90 - rest) * pi / 180;
+        c = sinSeries(angle);
+        s = cosSeries(angle);
+    }
+    switch (quadrant) {
+        case 0: return UnitVector{float(c), float(s)};
+        case 1: return UnitVector{float(-s), float(c)};
+        case 2: return UnitVector{float(-c), float(-s)};
+        default: return UnitVector{float(s), float(-c)};
+    }
+}
+
+constexpr std::array<UnitVector, 360> makeUnitVectors() {
+    std::array<UnitVector, 360> table{};
+    for (int degrees = 0; degrees < 360; ++degrees) {
+        table[degrees] = unitVectorOf(degrees);
+    }
+    return table;
+}
+
+} // namespace trig_detail
+
+/**
+ * @brief Unit vectors of all whole degree headings, computed at compile time
+ */
+constexpr std::array<UnitVector, 360> unitVectors = trig_detail::makeUnitVectors();
+
+/**
+ * @brief Direction of the heading in whole degrees
+ */
+constexpr UnitVector unitVector(int degrees) {
+    degrees %= 360;
+    return unitVectors[degrees < 0 ? degrees + 360 : degrees];
+}
+
+#endif // TRIG_H
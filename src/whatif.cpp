@@ -0,0 +1,463 @@
+/**
+ * @file whatif.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief What-if branches of the world simulated ahead in worker processes
+ * @details usage: simulation --whatif [--at T0] [--ticks T] [--every K] [--turn DEG] [--robot I] scene.txt
+ *          simulation --whatif-worker (started by WhatIfBranch, reads its branch from stdin)
+ *
+ * Runs the scene T0 ticks, then branches it twice: unchanged and with robot I (in the order
+ * of World::forEachRobot()) turned by DEG degrees. The main run keeps stepping while the
+ * branches look T ticks ahead, the unchanged branch must end where the main run does and
+ * the robots whose trajectories differ between the branches are listed.
+ */
+#include "whatif.h"
+#include "scene.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * @brief Branch sent to the worker, followed by imageSize bytes of the world image
+ */
+struct BranchRequest {
+    std::uint32_t index;  // handle of the changed robot
+    std::uint32_t generation;
+    std::int32_t turn;
+    std::uint32_t drive;
+    std::int64_t ticks;
+    std::int64_t every;
+    std::uint64_t imageSize;
+};
+
+/**
+ * @brief Write the whole buffer, the socket blocks the worker while the parent is behind
+ */
+static bool writeAll(int fd, const void* data, std::size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+static bool readAll(int fd, void* data, std::size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t received = ::read(fd, bytes, size);
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) return false;
+        bytes += received;
+        size -= static_cast<std::size_t>(received);
+    }
+    return true;
+}
+
+/**
+ * @brief Body of the worker: apply the change, run ahead and send the samples
+ */
+static void runBranch(World& world, const WhatIf& whatIf, int out) {
+    world.setFarSenseInterval(1);  // nobody watches the branch, every robot is simulated in full detail
+    if (world.contains(whatIf.robot)) {
+        RobotRecord record = world.robotRecord(whatIf.robot);
+        world.setPose(whatIf.robot, record.position.x, record.position.y, record.heading.orientation + whatIf.turn);
+        if (whatIf.drive) {
+            world.moveForward(whatIf.robot);  // autonomous robots ignore it
+        }
+    }
+    std::vector<BranchSample> samples;
+    for (long tick = 0; tick <= whatIf.ticks; ++tick) {
+        if (tick > 0) {
+            world.step();
+        }
+        if (tick % whatIf.every != 0) continue;
+        samples.clear();
+        world.forEachRobot([&](RobotKind, Handle handle, const Position& position, const Heading&, const ParamBlock&) {
+            samples.push_back(BranchSample{static_cast<std::uint32_t>(tick), handle.index, handle.generation, position.x, position.y});
+        });
+        if (!writeAll(out, samples.data(), samples.size() * sizeof(BranchSample))) return;  // the parent gave up
+    }
+}
+
+WhatIfBranch::~WhatIfBranch() {
+    stop();
+}
+
+/**
+ * @brief Kill the worker if it still runs and drop the socket
+ */
+void WhatIfBranch::stop() {
+    if (child > 0) {
+        kill(child, SIGKILL);
+        waitpid(child, nullptr, 0);
+        child = -1;
+    }
+    if (connection >= 0) {
+        close(connection);
+        connection = -1;
+    }
+}
+
+/**
+ * @brief Start a worker simulating the branch from a copy of the world, a running branch is abandoned
+ * @details the parent may run other threads (the window does), so the forked child only calls
+ * async-signal-safe functions until it executes this program again as the worker. Only what fits
+ * into the socket is sent now, write() sends the rest
+ *
+ * @param image the world as written by World::writeImage()
+ * @return false if the worker could not be started
+ */
+bool WhatIfBranch::start(std::shared_ptr<const std::vector<char>> image, const WhatIf& whatIf) {
+    stop();
+    change = whatIf;
+    change.every = std::max(1L, change.every);
+    done = false;
+    workerFailed = false;
+    pending.clear();
+    paths.clear();
+
+    int ends[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, ends) != 0) return false;
+    static char program[] = "simulation";
+    static char mode[] = "--whatif-worker";
+    char *arguments[] = {program, mode, nullptr};
+    child = fork();
+    if (child < 0) {
+        close(ends[0]);
+        close(ends[1]);
+        return false;
+    }
+    if (child == 0) {
+        dup2(ends[1], STDIN_FILENO);  // the duplicates stay open across exec, the originals do not
+        dup2(ends[1], STDOUT_FILENO);
+        execv("/proc/self/exe", arguments);
+        _exit(127);
+    }
+    close(ends[1]);
+    connection = ends[0];
+    fcntl(connection, F_SETFL, fcntl(connection, F_GETFL) | O_NONBLOCK);
+
+    BranchRequest header{change.robot.index, change.robot.generation, change.turn, change.drive ? 1u : 0u,
+                         change.ticks, change.every, image->size()};
+    request.assign(reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(&header) + sizeof(header));
+    this->image = std::move(image);
+    sent = 0;
+    write();
+    return true;
+}
+
+/**
+ * @brief Send as much of the request and the image as the socket takes without blocking
+ * @details a worker which is gone is noticed by read(), MSG_NOSIGNAL keeps it from killing the parent by SIGPIPE
+ *
+ * @return true while there is more to send
+ */
+bool WhatIfBranch::write() {
+    while (image && connection >= 0) {
+        bool header = sent < request.size();
+        const char* data = header ? request.data() + sent : image->data() + (sent - request.size());
+        std::size_t left = header ? request.size() - sent : image->size() - (sent - request.size());
+        if (left == 0) break;
+        ssize_t written = send(connection, data, left, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        if (written <= 0) break;
+        sent += static_cast<std::size_t>(written);
+    }
+    image.reset();
+    return false;
+}
+
+/**
+ * @brief Take the samples waiting in the socket without blocking
+ *
+ * @return false once the branch has finished, the trajectories are complete then
+ */
+bool WhatIfBranch::read() {
+    if (connection < 0) return false;
+    char buffer[16384];
+    bool ended = false;
+    for (;;) {
+        ssize_t received = ::read(connection, buffer, sizeof(buffer));
+        if (received > 0) {
+            pending.insert(pending.end(), buffer, buffer + received);
+        } else if (received < 0 && errno == EINTR) {
+            continue;
+        } else {
+            ended = received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+            break;
+        }
+    }
+
+    std::size_t whole = pending.size() / sizeof(BranchSample) * sizeof(BranchSample);
+    for (std::size_t offset = 0; offset < whole; offset += sizeof(BranchSample)) {
+        BranchSample sample;
+        std::memcpy(&sample, pending.data() + offset, sizeof(sample));
+        Handle handle{sample.index, sample.generation};
+        auto it = paths.find(handle.key());
+        if (it == paths.end()) {
+            it = paths.emplace(handle.key(), Trajectory{handle, sample.tick, {}}).first;
+        }
+        it->second.points.push_back(Position{sample.x, sample.y});
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(whole));
+
+    if (ended) {
+        close(connection);
+        connection = -1;
+        int status = 0;
+        waitpid(child, &status, 0);
+        workerFailed = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+        child = -1;
+        image.reset();
+        done = true;
+    }
+    return !done;
+}
+
+#else
+
+WhatIfBranch::~WhatIfBranch() {
+}
+
+void WhatIfBranch::stop() {
+}
+
+/**
+ * @brief The workers are processes started with fork() and exec(), there are none on this platform
+ */
+bool WhatIfBranch::start(std::shared_ptr<const std::vector<char>>, const WhatIf& whatIf) {
+    change = whatIf;
+    done = true;
+    workerFailed = true;
+    return false;
+}
+
+bool WhatIfBranch::write() {
+    return false;
+}
+
+bool WhatIfBranch::read() {
+    return false;
+}
+
+#endif
+
+/**
+ * @brief Trajectory of the robot in the branch
+ *
+ * @return nullptr if the robot did not exist in the branch
+ */
+const Trajectory* WhatIfBranch::trajectory(Handle robot) const {
+    auto it = paths.find(robot.key());
+    return it == paths.end() ? nullptr : &it->second;
+}
+
+/**
+ * @brief Robots whose trajectories differ by more than tolerance px, ordered by the tick of the difference
+ * @details a robot existing in one branch only is reported from its first sample with the offset -1
+ */
+std::vector<Divergence> compareBranches(const WhatIfBranch& base, const WhatIfBranch& other, float tolerance) {
+    std::vector<Divergence> result;
+    long every = base.whatIf().every;
+    for (const auto& entry : base.trajectories()) {
+        const Trajectory& path = entry.second;
+        const Trajectory* twin = other.trajectory(path.handle);
+        if (!twin || twin->firstTick != path.firstTick) {
+            result.push_back(Divergence{path.handle, path.firstTick, -1});
+            continue;
+        }
+        std::size_t count = std::min(path.points.size(), twin->points.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            if (std::hypot(path.points[i].x - twin->points[i].x, path.points[i].y - twin->points[i].y) > tolerance) {
+                const Position& last = path.points[count - 1];
+                const Position& lastTwin = twin->points[count - 1];
+                result.push_back(Divergence{path.handle, static_cast<std::uint32_t>(path.firstTick + i * every),
+                                            static_cast<float>(std::hypot(last.x - lastTwin.x, last.y - lastTwin.y))});
+                break;
+            }
+        }
+    }
+    for (const auto& entry : other.trajectories()) {
+        if (!base.trajectory(entry.second.handle)) {
+            result.push_back(Divergence{entry.second.handle, entry.second.firstTick, -1});
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Divergence& a, const Divergence& b) {
+        return a.tick < b.tick || (a.tick == b.tick && a.handle.index < b.handle.index);
+    });
+    return result;
+}
+
+#ifdef __linux__
+
+/**
+ * @brief Entry point of the headless what-if check
+ *
+ * @param argc number of arguments following --whatif
+ * @param argv arguments following --whatif
+ * @return int exit code, 1 if the unchanged branch does not end where the main run does
+ */
+int runWhatIf(int argc, char *argv[]) {
+    long at = 0, ticks = 300, every = 5, turn = 45, robotIndex = 0;
+    std::string file;
+    bool valid = true;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--at" || arg == "--ticks" || arg == "--every" || arg == "--turn" || arg == "--robot") && i + 1 < argc) {
+            long value = std::strtol(argv[++i], nullptr, 10);
+            if (arg == "--at") at = value;
+            else if (arg == "--ticks") ticks = value;
+            else if (arg == "--every") every = value;
+            else if (arg == "--turn") turn = value;
+            else robotIndex = value;
+        } else if (!arg.empty() && arg[0] != '-' && file.empty()) {
+            file = arg;
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid || file.empty() || at < 0 || ticks <= 0 || every <= 0 || robotIndex < 0) {
+        std::fprintf(stderr, "usage: simulation --whatif [--at T0] [--ticks T] [--every K] [--turn DEG] [--robot I] scene.txt\n");
+        return 2;
+    }
+    Scene scene;
+    if (!loadScene(file, scene)) {
+        std::fprintf(stderr, "Cannot open file for reading: %s\n", file.c_str());
+        return 2;
+    }
+    World world;
+    populateWorld(world, scene);
+    for (long tick = 0; tick < at; ++tick) {
+        world.step();
+    }
+    std::vector<Handle> robots;
+    world.forEachRobot([&](RobotKind, Handle handle, const Position&, const Heading&, const ParamBlock&) {
+        robots.push_back(handle);
+    });
+    if (robotIndex >= static_cast<long>(robots.size())) {
+        std::fprintf(stderr, "The scene has %zu robots at tick %ld\n", robots.size(), at);
+        return 2;
+    }
+    Handle robot = robots[robotIndex];
+
+    auto image = std::make_shared<std::vector<char>>();
+    world.writeImage(*image);
+    WhatIfBranch baseline, branch;
+    if (!baseline.start(image, WhatIf{Handle{}, 0, false, ticks, every})
+        || !branch.start(image, WhatIf{robot, static_cast<int>(turn), true, ticks, every})) {
+        std::fprintf(stderr, "Cannot start the what-if workers\n");
+        return 2;
+    }
+    // the main run goes on while the branches look ahead
+    long mainTicks = 0;
+    while (!baseline.finished() || !branch.finished()) {
+        if (mainTicks < ticks) {
+            world.step();
+            ++mainTicks;
+        }
+        pollfd ready[2] = {{baseline.fd(), static_cast<short>(POLLIN | (baseline.sending() ? POLLOUT : 0)), 0},
+                           {branch.fd(), static_cast<short>(POLLIN | (branch.sending() ? POLLOUT : 0)), 0}};
+        if (poll(ready, 2, mainTicks < ticks ? 0 : -1) < 0 && errno != EINTR) break;
+        if (ready[0].revents & POLLOUT) baseline.write();
+        if (ready[1].revents & POLLOUT) branch.write();
+        if (ready[0].revents & ~POLLOUT) baseline.read();
+        if (ready[1].revents & ~POLLOUT) branch.read();
+    }
+    if (baseline.failed() || branch.failed()) {
+        std::fprintf(stderr, "A what-if worker failed\n");
+        return 2;
+    }
+    for (; mainTicks < ticks; ++mainTicks) {
+        world.step();
+    }
+
+    // with T a multiple of K the last sample of the unchanged branch is the state of the main run
+    std::size_t last = static_cast<std::size_t>(ticks / every);
+    std::size_t mismatches = 0;
+    world.forEachRobot([&](RobotKind, Handle handle, const Position& position, const Heading&, const ParamBlock&) {
+        const Trajectory* path = baseline.trajectory(handle);
+        std::size_t index = path ? last - path->firstTick / every : 0;
+        bool same = path && ticks % every == 0 && index < path->points.size()
+            && path->points[index].x == position.x && path->points[index].y == position.y;
+        mismatches += same || ticks % every != 0 ? 0 : 1;
+    });
+    std::printf("robot %ld (handle %u:%u) turned by %ld degrees at tick %ld, %ld ticks ahead, %zu robots\n",
+                robotIndex, robot.index, robot.generation, turn, at, ticks, robots.size());
+    if (ticks % every == 0) {
+        std::printf("unchanged branch %s the main run\n", mismatches == 0 ? "matches" : "differs from");
+    }
+    const Trajectory* before = baseline.trajectory(robot);
+    const Trajectory* after = branch.trajectory(robot);
+    if (before && after && !before->points.empty() && !after->points.empty()) {
+        std::printf("robot ends at (%.1f, %.1f) unchanged and at (%.1f, %.1f) turned\n",
+                    before->points.back().x, before->points.back().y, after->points.back().x, after->points.back().y);
+    }
+    std::vector<Divergence> divergences = compareBranches(baseline, branch);
+    std::printf("%zu robots diverge\n", divergences.size());
+    for (const Divergence& divergence : divergences) {
+        if (divergence.offset < 0) {
+            std::printf("  robot %u:%u exists in one branch only, from tick %u\n",
+                        divergence.handle.index, divergence.handle.generation, divergence.tick);
+        } else {
+            std::printf("  robot %u:%u from tick %u, %.1f px apart at the end\n",
+                        divergence.handle.index, divergence.handle.generation, divergence.tick, divergence.offset);
+        }
+    }
+    return mismatches == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Entry point of the worker process of a WhatIfBranch
+ * @details reads the BranchRequest and the world image from stdin and writes the samples to stdout
+ *
+ * @return int exit code
+ */
+int runWhatIfWorker(int argc, char *argv[]) {
+    (void)argv;
+    if (argc != 0) {
+        std::fprintf(stderr, "usage: simulation --whatif-worker, started by the what-if branches\n");
+        return 2;
+    }
+    BranchRequest request;
+    if (!readAll(STDIN_FILENO, &request, sizeof(request))) return 2;
+    std::vector<char> image(request.imageSize);
+    World world;
+    if (!readAll(STDIN_FILENO, image.data(), image.size()) || !world.readImage(image)) {
+        std::fprintf(stderr, "The what-if worker got a damaged world image\n");
+        return 2;
+    }
+    WhatIf change{Handle{request.index, request.generation}, request.turn, request.drive != 0,
+                  static_cast<long>(request.ticks), static_cast<long>(request.every)};
+    runBranch(world, change, STDOUT_FILENO);
+    return 0;
+}
+
+#else
+
+int runWhatIf(int, char *[]) {
+    std::fprintf(stderr, "--whatif is not supported on this platform, the branches are forked processes\n");
+    return 2;
+}
+
+int runWhatIfWorker(int, char *[]) {
+    return 2;
+}
+
+#endif
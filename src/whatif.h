@@ -0,0 +1,101 @@
+/**
+ * @file whatif.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief What-if branches of the world simulated ahead in worker processes
+ */
+#ifndef WHATIF_H
+#define WHATIF_H
+
+#include "world.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Change of the world a branch starts with and how far it looks ahead
+ */
+struct WhatIf {
+    Handle robot;  // null handle to branch the world unchanged
+    int turn = 0;  // degrees added to the orientation of the robot, positive clockwise
+    bool drive = false;  // a remote robot starts moving forward
+    long ticks = 300;
+    long every = 5;  // ticks between two samples of the trajectories
+};
+
+/**
+ * @brief Position of a robot in a branch as sent over the socket
+ */
+struct BranchSample {
+    std::uint32_t tick;
+    std::uint32_t index;  // handle of the robot
+    std::uint32_t generation;
+    float x, y;
+};
+
+/**
+ * @brief Sampled positions of a robot in a branch
+ */
+struct Trajectory {
+    Handle handle;
+    std::uint32_t firstTick;  // robots spawned in the branch start later
+    std::vector<Position> points;  // one per sample
+};
+
+/**
+ * @class WhatIfBranch
+ * @brief Copy of the world in a worker process which applies a WhatIf and runs ahead
+ * @details the worker is this program started again with --whatif-worker, it receives the
+ * image of the world (see World::writeImage()) and the change over a socket, so the parent
+ * keeps simulating meanwhile and may run other threads. Neither direction blocks: call write()
+ * when fd() is writable while sending() and read() when it is readable; branches of the same
+ * state share one image
+ */
+class WhatIfBranch {
+public:
+    WhatIfBranch() = default;
+    WhatIfBranch(const WhatIfBranch&) = delete;
+    WhatIfBranch& operator=(const WhatIfBranch&) = delete;
+    ~WhatIfBranch();
+
+    bool start(std::shared_ptr<const std::vector<char>> image, const WhatIf& whatIf);
+    bool write();
+    bool read();
+    int fd() const { return connection; }
+    bool sending() const { return image != nullptr; }
+    bool finished() const { return done; }
+    bool failed() const { return workerFailed; }
+    const WhatIf& whatIf() const { return change; }
+    const std::unordered_map<std::uint64_t, Trajectory>& trajectories() const { return paths; }
+    const Trajectory* trajectory(Handle robot) const;
+
+private:
+    WhatIf change;
+    int child = -1;  // process id of the worker
+    int connection = -1;  // socket to the worker
+    bool done = false;
+    bool workerFailed = false;  // the worker did not start or did not exit cleanly
+    std::vector<char> request;  // sent before the image
+    std::shared_ptr<const std::vector<char>> image;  // dropped once it is sent
+    std::size_t sent = 0;  // bytes of the request and the image sent so far
+    std::vector<char> pending;  // incomplete sample at the end of the last read
+    std::unordered_map<std::uint64_t, Trajectory> paths;
+
+    void stop();
+};
+
+/**
+ * @brief Robot whose trajectories differ between two branches
+ */
+struct Divergence {
+    Handle handle;
+    std::uint32_t tick;  // first sample where the positions differ
+    float offset;  // distance of the last positions in px
+};
+
+std::vector<Divergence> compareBranches(const WhatIfBranch& base, const WhatIfBranch& other, float tolerance = 0.5f);
+
+int runWhatIf(int argc, char *argv[]);
+int runWhatIfWorker(int argc, char *argv[]);
+
+#endif // WHATIF_H
@@ -0,0 +1,1624 @@
+/**
+ * @file world.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief File containing the simulation engine systems
+ */
+#include "world.h"
+#include "behaviors.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+static constexpr double minRowGap = 8;  // rows of positions fitting one cache line
+static constexpr double sweepSlack = 0.5;  // px added to a swept field of vision for rounding of the positions
+static constexpr int maxKineticHorizon = 1024;  // ticks a robot may skip its sensor at most
+
+/**
+ * @brief Finalizer of splitmix64, spreads every input bit over the whole result
+ */
+static std::uint64_t mix(std::uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+static std::uint64_t floatBits(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+ * @brief Hash of one entity from its handle and exact state
+ */
+static std::uint64_t entityHash(Handle handle, float x, float y, std::uint64_t rest) {
+    std::uint64_t h = mix(handle.key());
+    h = mix(h ^ (floatBits(x) << 32 | floatBits(y)));
+    return mix(h ^ rest);
+}
+
+static std::uint64_t obstacleHash(Handle handle, const ObstacleShape& shape) {
+    return entityHash(handle, shape.x, shape.y, floatBits(shape.halfWidth));
+}
+
+/**
+ * @brief Set the scene bounds robots can not leave, the obstacle grid is rebuilt for them
+ */
+void World::setBounds(const Box& newBounds) {
+    sceneBounds = newBounds;
+    obstaclesDirty = true;
+    schedulesStale = true;
+    parkedStale = true;
+}
+
+/**
+ * @brief Number of chunks the world is split into, see chunkSize
+ */
+std::size_t World::chunkCount() const {
+    ChunkLayout layout;
+    layout.reset(sceneBounds);
+    return static_cast<std::size_t>(layout.cellCount());
+}
+
+/**
+ * @brief Add square obstacle centered at the given point
+ *
+ * @return handle of the obstacle
+ */
+Handle World::addObstacle(double x, double y, double width) {
+    Handle handle = slots.insert(obstacleTable, static_cast<std::uint32_t>(obstacles.size()));
+    ObstacleShape shape{float(x), float(y), float(width / 2)};
+    obstacles.add(Identity{handle}, shape);
+    obstacleHashSum += obstacleHash(handle, shape);
+    obstacleContentSum += obstacleHash(Handle{}, shape);
+    obstaclesDirty = true;
+    schedulesStale = true;
+    return handle;
+}
+
+/**
+ * @brief Remove obstacle in O(1) by moving the last obstacle into its place
+ *
+ * @return false if the handle is stale or is not an obstacle
+ */
+bool World::removeObstacle(Handle handle) {
+    const SlotMap::Slot* slot = slots.find(handle);
+    if (!slot || slot->table != obstacleTable) return false;
+
+    const ObstacleShape& shape = obstacles.get<ObstacleShape>(slot->row);
+    obstacleHashSum -= obstacleHash(handle, shape);
+    obstacleContentSum -= obstacleHash(Handle{}, shape);
+    removeRow(obstacles, slot->row);
+    slots.erase(handle);
+    obstaclesDirty = true;
+    return true;
+}
+
+/**
+ * @brief Switch between the floating point and the fixed point engine
+ * @details in fixed point mode positions are kept on a 1/16 px grid and moved with
+ * integer arithmetic and table trigonometry, so a run gives the same result on
+ * every machine. Positions of existing robots are snapped to the grid
+ */
+void World::setFixedPoint(bool enabled) {
+    fixedMode = enabled;
+    schedulesStale = true;
+    if (!enabled) return;
+    for (Position& position : autonomous.column<Position>()) {
+        position = placed(position.x, position.y);
+    }
+    for (Position& position : remote.column<Position>()) {
+        position = placed(position.x, position.y);
+    }
+}
+
+/**
+ * @brief Let the robots of the kind check their field of vision every interval ticks
+ * @details a robot checking its field of vision also checks the area it sweeps until its
+ * next check, widened by how far the other robots can move meanwhile. Only when that
+ * area is free the checks in between are skipped, otherwise the robot checks every tick,
+ * so the simulation gives the same result with any interval. The checks of the robots
+ * are staggered over the ticks of the interval
+ *
+ * @param interval ticks between two checks, 1 checks every tick
+ */
+void World::setSenseInterval(RobotKind kind, int interval) {
+    senseIntervals[static_cast<int>(kind)] = std::max(1, std::min(interval, int(UINT16_MAX)));
+    schedulesStale = true;
+}
+
+/**
+ * @brief Let every robot skip its sensor for as long as nothing can enter its field of vision
+ * @details a robot checking its field of vision finds the longest of 2, 4, 8 ... ticks
+ * whose swept area is free (see setSenseInterval()) and checks next only when that
+ * time runs out, so robots travelling through free space are not sensed for
+ * hundreds of ticks and the simulation still gives the same result. It overrides
+ * the sensing interval
+ */
+void World::setKineticScheduling(bool enabled) {
+    kineticMode = enabled;
+    schedulesStale = true;
+}
+
+/**
+ * @brief Let the robots see each other at their positions from the start of the tick
+ * @details by default a robot sees the robots processed before it at their new positions,
+ * so the result depends on the order of the rows. With synchronous sensing every robot
+ * moves as a function of the state at the start of the tick only, so the world can be
+ * split into regions simulated independently with the same result, see setHalo().
+ * A robot placed by a source keeps clear of where the others may have moved meanwhile
+ */
+void World::setSynchronousSensing(bool enabled) {
+    synchronousMode = enabled;
+    schedulesStale = true;
+}
+
+/**
+ * @brief Set the robots simulated by other worlds near the bounds of this one for the next tick
+ * @details they are seen like the own robots but not simulated, every robot senses again
+ * as they change every tick, see setSynchronousSensing()
+ */
+void World::setHalo(const std::vector<HaloRobot>& robots) {
+    std::size_t count = std::min<std::size_t>(robots.size(), std::size_t(maxBinnedRow) + 1);  // rows are binned as well
+    halo.assign(robots.begin(), robots.begin() + static_cast<std::ptrdiff_t>(count));
+    schedulesStale = true;
+}
+
+/**
+ * @brief Distance from a robot within which another robot can change its next move
+ * @details the farthest corner of the largest field of vision of the robots and of the ones
+ * the sources will spawn, the body of the other robot and the step the robot takes before it senses
+ */
+double World::sensingReach() const {
+    double reach = 0;
+    double step = 0;
+    for (const ParamBlock& block : paramBlocks) {
+        for (const Vec2& corner : block.localView) {
+            reach = std::max(reach, std::hypot(corner.x, corner.y));
+        }
+        step = std::max(step, std::fabs(InterpolatedMotion::stepLength(block)));
+    }
+    for (const Source& source : sources) {  // robots it will spawn
+        Vec2 view[4];
+        localFieldOfView(source.detectionRadius, view);
+        reach = std::max(reach, std::hypot(view[2].x, view[2].y));
+        step = std::max(step, 0.1 * std::abs(source.speed));
+    }
+    return reach + robotRadius * std::sqrt(2.0) + step + 1;
+}
+
+/**
+ * @brief Robots of this world inside the area as another world sees them, see setHalo()
+ */
+std::vector<HaloRobot> World::haloRobots(const Box& area) const {
+    std::vector<HaloRobot> robots;
+    forEachRobot([&](RobotKind, Handle, const Position& position, const Heading&, const ParamBlock& params) {
+        if (boxContains(area, position.x, position.y)) {
+            float reach = float(std::fabs(InterpolatedMotion::stepLength(params)) + roundingPerTick());
+            robots.push_back(HaloRobot{position, reach});
+        }
+    });
+    return robots;
+}
+
+/**
+ * @brief Let the sensors overlook a detected obstacle or robot with the given probability per check
+ * @details 0 turns the noise off, the seed makes the misses reproducible, see missesDetection()
+ */
+void World::setSensorNoise(double missProbability, std::uint64_t seed) {
+    double p = std::min(std::max(missProbability, 0.0), 1.0);
+    missThreshold = p >= 1 ? ~std::uint64_t(0) : static_cast<std::uint64_t>(std::ldexp(p, 64));
+    noiseSeed = seed;
+}
+
+/**
+ * @brief Let autonomous robots outside the focus check their field of vision only every interval ticks
+ * @details a cheap level of detail for the parts of a large world nobody looks at, see setFocus().
+ * Unlike setSenseInterval() the skipped ticks are not looked ahead, so far robots notice what enters
+ * their field of vision up to interval - 1 ticks late. The interval of a robot is capped so that it
+ * moves at most half of its detection radius meanwhile, so it still notices a static obstacle at
+ * least half of its detection radius ahead. 1 (the default) keeps the run exact
+ */
+void World::setFarSenseInterval(int interval) {
+    farInterval = std::max(1, std::min(interval, int(UINT16_MAX)));
+    schedulesStale = true;
+}
+
+/**
+ * @brief Upper bound of the drift of a position from rounding in one tick, in px
+ * @details fixed point steps are rounded to 1/16 px, float positions to their precision
+ */
+double World::roundingPerTick() const {
+    if (fixedMode) {
+        return 0.05;
+    }
+    double extent = std::max(std::max(std::fabs(sceneBounds.minX), std::fabs(sceneBounds.maxX)),
+                             std::max(std::fabs(sceneBounds.minY), std::fabs(sceneBounds.maxY)));
+    return std::max(1e-4, std::ldexp(extent, -21));
+}
+
+/**
+ * @brief Make every robot check its field of vision on the next tick
+ */
+void World::resetSenseSchedules() {
+    for (SenseSchedule& schedule : autonomous.column<SenseSchedule>()) {
+        schedule = SenseSchedule{};
+    }
+    // something may have appeared in the field of vision of the parked robots
+    for (std::uint32_t row = 0; row < autonomous.size() && sleepingRobots > 0; ++row) {
+        wake(autonomous, row);
+    }
+    for (SenseSchedule& schedule : remote.column<SenseSchedule>()) {
+        schedule = SenseSchedule{};
+    }
+    schedulesStale = false;
+}
+
+/**
+ * @brief Put the robot to sleep, it is not simulated until wake() is called
+ */
+template <typename Table>
+void World::sleep(Table& table, std::uint32_t row) {
+    table.template get<Activity>(row).asleep = true;
+    ++sleepingRobots;
+    fellAsleep = true;
+    // autonomous robots park only at speed 0 and are in the parked bins already
+    parkedStale = parkedStale || std::is_same<Table, RemoteTable>::value;
+}
+
+/**
+ * @brief Wake the robot up if it sleeps, it checks its field of vision on the next tick
+ */
+template <typename Table>
+void World::wake(Table& table, std::uint32_t row) {
+    Activity& activity = table.template get<Activity>(row);
+    if (!activity.asleep) return;
+    activity.asleep = false;
+    table.template get<SenseSchedule>(row) = SenseSchedule{};
+    --sleepingRobots;
+    constexpr bool isRemote = std::is_same<Table, RemoteTable>::value;
+    wokenRows[static_cast<int>(isRemote ? RobotKind::Remote : RobotKind::Autonomous)].push_back(row);
+    parkedStale = parkedStale || isRemote;
+}
+
+/**
+ * @brief Check if stepping the world would change nothing
+ * @details all robots sleep, no source can spawn and nothing has to be rechecked,
+ * e.g. the window can stop its timer until the next command
+ */
+bool World::isIdle() const {
+    if (awakeCount() > 0 || schedulesStale) {
+        return false;
+    }
+    for (const Source& source : sources) {
+        if (source.limit == 0 || source.spawned < source.limit) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Append rows of the awake robots of the table
+ */
+template <typename Table>
+void World::collectAwake(const Table& table, std::vector<std::uint32_t>& rows) {
+    rows.clear();
+    const auto& activity = table.template column<Activity>();
+    for (std::uint32_t row = 0; row < activity.size(); ++row) {
+        if (!activity[row].asleep) rows.push_back(row);
+    }
+}
+
+/**
+ * @brief Merge the woken rows into the awake rows and drop the robots which fell asleep
+ * @details both lists are ascending, the merge goes through a kept scratch list, so it does not touch the heap
+ */
+template <typename Table>
+void World::refreshAwake(const Table& table, std::vector<std::uint32_t>& rows, std::vector<std::uint32_t>& woken) {
+    std::sort(woken.begin(), woken.end());
+    mergedRows.clear();
+    auto next = woken.begin();
+    for (std::uint32_t row : rows) {
+        for (; next != woken.end() && *next < row; ++next) {
+            mergedRows.push_back(*next);
+        }
+        if (!table.template get<Activity>(row).asleep) mergedRows.push_back(row);
+    }
+    mergedRows.insert(mergedRows.end(), next, woken.end());
+    rows.swap(mergedRows);
+    woken.clear();
+}
+
+/**
+ * @brief Check if the robot can not move before a command, such robots are kept in the parked bins
+ */
+bool World::isStationary(RobotKind kind, std::uint32_t row) const {
+    if (kind == RobotKind::Autonomous) {
+        return paramBlocks[autonomous.get<Params>(row).block].speed == 0;
+    }
+    return remote.get<Activity>(row).asleep;
+}
+
+/**
+ * @brief Wake parked robots whose alarm is due and bring the awake rows and the parked bins up to date
+ * @details rows are collected again only after rows moved, woken robots are merged into the lists and
+ * robots which fell asleep are dropped from them. The parked bins hold the sleeping remote robots and
+ * the autonomous robots with speed 0, so they are rebuilt only when rows move or a remote robot
+ * falls asleep or wakes up
+ */
+void World::updateActivity() {
+    while (!alarms.empty() && alarms.front().tick <= elapsedTicks) {
+        Handle handle = alarms.front().handle;
+        std::pop_heap(alarms.begin(), alarms.end(), std::greater<WakeAlarm>());
+        alarms.pop_back();
+        const SlotMap::Slot* slot = slots.find(handle);
+        if (slot && slot->table == static_cast<std::uint8_t>(RobotKind::Autonomous)) {
+            wake(autonomous, slot->row);
+        }
+    }
+
+    constexpr int autonomousKind = static_cast<int>(RobotKind::Autonomous);
+    constexpr int remoteKind = static_cast<int>(RobotKind::Remote);
+    if (awakeStale) {
+        collectAwake(autonomous, awakeRows[autonomousKind]);
+        collectAwake(remote, awakeRows[remoteKind]);
+        wokenRows[autonomousKind].clear();
+        wokenRows[remoteKind].clear();
+        awakeStale = false;
+    } else {
+        if (fellAsleep || !wokenRows[autonomousKind].empty()) {
+            refreshAwake(autonomous, awakeRows[autonomousKind], wokenRows[autonomousKind]);
+        }
+        if (fellAsleep || !wokenRows[remoteKind].empty()) {
+            refreshAwake(remote, awakeRows[remoteKind], wokenRows[remoteKind]);
+        }
+    }
+    fellAsleep = false;
+
+    if (!parkedStale) return;
+    parkedStale = false;
+    parkedBins.invalidate();
+    auto forEachParked = [&](auto f) {
+        for (std::uint32_t row = 0; row < autonomous.size(); ++row) {
+            if (isStationary(RobotKind::Autonomous, row)) f(RobotKind::Autonomous, row, autonomous.get<Position>(row));
+        }
+        for (std::uint32_t row = 0; row < remote.size(); ++row) {
+            if (isStationary(RobotKind::Remote, row)) f(RobotKind::Remote, row, remote.get<Position>(row));
+        }
+    };
+    std::size_t parked = 0;
+    forEachParked([&](RobotKind, std::uint32_t, const Position&) { ++parked; });
+    if (parked == 0) return;
+    parkedArena.reset();
+    parkedBins.begin(sceneBounds, parked, parkedArena);
+    forEachParked([&](RobotKind, std::uint32_t, const Position& position) {
+        parkedBins.tally(position.x, position.y);
+    });
+    parkedBins.prepare(parkedArena);
+    forEachParked([&](RobotKind, std::uint32_t, const Position& position) {
+        parkedBins.count(position.x, position.y);
+    });
+    parkedBins.prefixSum();
+    forEachParked([&](RobotKind kind, std::uint32_t row, const Position& position) {
+        parkedBins.place(position.x, position.y, static_cast<std::uint8_t>(kind), row);
+    });
+    parkedBins.finish();
+}
+
+/**
+ * @brief Position of a new robot, snapped to the fixed point grid in fixed point mode
+ */
+Position World::placed(double x, double y) const {
+    if (!fixedMode) {
+        return Position{float(x), float(y)};
+    }
+    return Position{float(fromFixed(toFixed(x))), float(fromFixed(toFixed(y)))};
+}
+
+/**
+ * @brief Rebuild the obstacle grid if obstacles or bounds changed since the last rebuild
+ * @details a new index is built, so worlds sharing the old one keep it, see shareObstacles()
+ */
+void World::updateObstacleGrid() {
+    if (!obstaclesDirty) return;
+    FrameArena scratch(0);  // a rebuild is rare, keep its scratch off the frame arena
+    sortByMortonKey<ObstacleShape>(obstacles, [](const ObstacleShape& shape) { return Vec2{shape.x, shape.y}; }, scratch);
+    const auto& shapes = obstacles.column<ObstacleShape>();
+    auto index = std::make_shared<ObstacleIndex>();
+    index->boxes.reserve(shapes.size());
+    for (const ObstacleShape& shape : shapes) {
+        index->boxes.push_back(shape.box());
+    }
+    index->grid.build(sceneBounds, shapes.size(), [&](std::uint32_t row) { return index->boxes[row]; });
+    index->key = obstacleKey();
+    obstacleIndex = std::move(index);
+    obstaclesDirty = false;
+}
+
+/**
+ * @brief Hash of the bounds and the obstacles, it does not depend on their order
+ */
+std::uint64_t World::obstacleKey() const {
+    std::uint64_t key = mix(floatBits(float(sceneBounds.minX)) << 32 | floatBits(float(sceneBounds.minY)))
+                        ^ mix(floatBits(float(sceneBounds.maxX)) << 32 | floatBits(float(sceneBounds.maxY)));
+    for (const ObstacleShape& shape : obstacles.column<ObstacleShape>()) {
+        key += mix(mix(floatBits(shape.x) << 32 | floatBits(shape.y)) ^ floatBits(shape.halfWidth));
+    }
+    return key;
+}
+
+/**
+ * @brief Build the obstacle grid now instead of on the next tick
+ * @details other threads may then share it (shareObstacles()) while this world is not stepped
+ */
+void World::prepareObstacles() {
+    updateObstacleGrid();
+}
+
+/**
+ * @brief Use the obstacle grid of another world with the same bounds and obstacles
+ * @details the grid is immutable and its memory is held once for all the worlds sharing it,
+ * a world changing its obstacles later builds its own again
+ *
+ * @return false if the obstacles differ, the world keeps its own grid then
+ */
+bool World::shareObstacles(World& other) {
+    other.updateObstacleGrid();
+    if (obstacles.size() != other.obstacles.size() || obstacleKey() != other.obstacleIndex->key) {
+        return false;
+    }
+    obstacleIndex = other.obstacleIndex;
+    obstaclesDirty = false;
+    return true;
+}
+
+/**
+ * @brief Test the robots against the obstacles of another world without copying them
+ * @details the world takes the immutable grid of the other one as it is, its own obstacle table is
+ * not looked at until it adds or removes an obstacle, which builds a grid of its own table again;
+ * used by the look-ahead snapshots of a small part of a large world
+ *
+ * @return false if the other world has not built the grid of its current obstacles yet
+ */
+bool World::borrowObstacles(const World& other) {
+    if (other.obstaclesDirty || !other.obstacleIndex) {
+        return false;
+    }
+    obstacleIndex = other.obstacleIndex;
+    obstaclesDirty = false;
+    return true;
+}
+
+/**
+ * @brief Call hit(box) for obstacles near the box until it returns true
+ * @details a dirty grid is not queried, all obstacles are checked instead
+ */
+template <typename F>
+bool World::anyObstacle(const Box& box, F hit) const {
+    if (!obstaclesDirty) {
+        const std::vector<Box>& boxes = obstacleIndex->boxes;
+        return obstacleIndex->grid.query(box, [&](std::uint32_t row) { return hit(boxes[row]); });
+    }
+    for (const ObstacleShape& shape : obstacles.column<ObstacleShape>()) {
+        if (hit(shape.box())) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Reorder the table by Z-order of the entity centers and update their slots
+ *
+ * @param centerOf centerOf(component) returns the center of the entity
+ */
+template <typename Component, typename Table, typename F>
+void World::sortByMortonKey(Table& table, F centerOf, FrameArena& scratch) {
+    std::size_t count = table.size();
+    if (count < 2) return;
+
+    // key in the high half, row in the low half, so one sort orders the rows
+    std::uint64_t* keys = scratch.allocate<std::uint64_t>(count);
+    const auto& components = table.template column<Component>();
+    for (std::size_t row = 0; row < count; ++row) {
+        Vec2 center = centerOf(components[row]);
+        keys[row] = (std::uint64_t(mortonKey(sceneBounds, center.x, center.y)) << 32) | row;
+    }
+    std::sort(keys, keys + count);
+
+    std::uint32_t* order = scratch.allocate<std::uint32_t>(count);
+    for (std::size_t row = 0; row < count; ++row) {
+        order[row] = static_cast<std::uint32_t>(keys[row]);
+    }
+    table.permute(order, scratch);
+    for (std::uint32_t row = 0; row < count; ++row) {
+        slots.relocate(table.template get<Identity>(row).handle, row);
+    }
+}
+
+/**
+ * @brief Restore spatial order of the robot tables once robots sharing a cell drifted apart in memory
+ * @details the tables are sorted when the row gap measured while binning doubles
+ * compared to the gap right after the last sort, the decision does not depend
+ * on timing, so runs stay deterministic
+ */
+void World::sortRobots() {
+    if (sortedLastTick) {
+        sortedRowGap = measuredRowGap;
+        sortedLastTick = false;
+    }
+    if (!spatialSorting || measuredRowGap <= std::max(minRowGap, 2 * sortedRowGap)) return;
+    auto centerOf = [](const Position& position) { return Vec2{position.x, position.y}; };
+    sortByMortonKey<Position>(autonomous, centerOf, frameArena);
+    sortByMortonKey<Position>(remote, centerOf, frameArena);
+    awakeStale = true;
+    parkedStale = true;
+    sortedLastTick = true;
+    ++totalSorts;
+}
+
+/**
+ * @brief Find or create the parameter block with the given values
+ * @details robots configured the same way share one block
+ *
+ * @return index of the block
+ */
+std::uint32_t World::internParams(double detectionRadius, double avoidanceAngle, int speed) {
+    ParamBlock block{float(detectionRadius), float(avoidanceAngle), speed, {}, {}};
+    auto key = std::make_tuple(block.detectionRadius, block.avoidanceAngle, block.speed);
+    auto it = paramIndex.find(key);
+    if (it != paramIndex.end()) {
+        return it->second;
+    }
+    localFieldOfView(block.detectionRadius, block.localView);
+    fixedLocalFieldOfView(block.detectionRadius, block.fixedView);
+    std::uint32_t index = static_cast<std::uint32_t>(paramBlocks.size());
+    paramBlocks.push_back(block);
+    paramIndex.emplace(key, index);
+    return index;
+}
+
+/**
+ * @brief Register named robot template, an existing template of the same name is replaced
+ *
+ * @return index of its parameter block
+ */
+std::uint32_t World::addTemplate(const std::string& name, double detectionRadius, double avoidanceAngle, int speed) {
+    std::uint32_t block = internParams(detectionRadius, avoidanceAngle, speed);
+    templates[name] = block;
+    return block;
+}
+
+/**
+ * @brief Find robot template by its name
+ *
+ * @return parameters of the template or nullptr if there is no such template
+ */
+const ParamBlock* World::findTemplate(const std::string& name) const {
+    auto it = templates.find(name);
+    return it == templates.end() ? nullptr : &paramBlocks[it->second];
+}
+
+/**
+ * @brief Add autonomous robot
+ *
+ * @param orient orientation index (0 top, 1 right, 2 bottom, 3 left)
+ * @return handle of the robot, null handle if the table is full (see maxBinnedRow)
+ */
+Handle World::addAutonomousRobot(double x, double y, int orient, double detectionRadius, double avoidanceAngle, int speed) {
+    if (autonomous.size() > maxBinnedRow) return Handle{};
+    std::uint16_t orientation;
+    switch (orient) {
+        case 0: orientation = 270; break; // top
+        case 1: orientation = 0;   break; // right
+        case 2: orientation = 90;  break; // bottom
+        case 3: orientation = 180; break; // left
+        default: orientation = 0;  break; // default right
+    }
+    Handle handle = slots.insert(static_cast<std::uint8_t>(RobotKind::Autonomous), static_cast<std::uint32_t>(autonomous.size()));
+    autonomous.add(Identity{handle}, placed(x, y), Heading{orientation},
+                   Params{internParams(detectionRadius, avoidanceAngle, speed)}, SenseSchedule{}, Activity{});
+    schedulesStale = true;
+    awakeStale = true;
+    parkedStale = parkedStale || isStationary(RobotKind::Autonomous, static_cast<std::uint32_t>(autonomous.size() - 1));
+    return handle;
+}
+
+/**
+ * @brief Add remote controlled robot, it starts stopped and facing right
+ *
+ * @return handle of the robot, null handle if the table is full (see maxBinnedRow)
+ */
+Handle World::addRemoteRobot(double x, double y, int speed, double detectionRadius) {
+    if (remote.size() > maxBinnedRow) return Handle{};
+    Handle handle = slots.insert(static_cast<std::uint8_t>(RobotKind::Remote), static_cast<std::uint32_t>(remote.size()));
+    remote.add(Identity{handle}, placed(x, y), Heading{0},
+               Params{internParams(detectionRadius, 0, speed)}, SenseSchedule{}, Activity{}, RemoteControl{});
+    schedulesStale = true;
+    awakeStale = true;
+    return handle;
+}
+
+/**
+ * @brief State of the robot to be inserted into another world
+ * @details the handle must refer to a live robot
+ */
+RobotRecord World::robotRecord(Handle handle) const {
+    const SlotMap::Slot* slot = slots.find(handle);
+    RobotRecord record{};
+    auto fill = [&](const auto& table) {
+        const ParamBlock& block = paramBlocks[table.template get<Params>(slot->row).block];
+        record.position = table.template get<Position>(slot->row);
+        record.heading = table.template get<Heading>(slot->row);
+        record.detectionRadius = block.detectionRadius;
+        record.avoidanceAngle = block.avoidanceAngle;
+        record.speed = block.speed;
+    };
+    if (slot->table == static_cast<std::uint8_t>(RobotKind::Autonomous)) {
+        record.kind = RobotKind::Autonomous;
+        fill(autonomous);
+    } else {
+        record.kind = RobotKind::Remote;
+        fill(remote);
+        record.control = remote.get<RemoteControl>(slot->row);
+    }
+    return record;
+}
+
+/**
+ * @brief Add robot with the exact state of the record, e.g. a robot moving in from another world
+ *
+ * @return handle of the robot, it differs from the handle in the other world,
+ * null handle if the table is full (see maxBinnedRow)
+ */
+Handle World::insertRobot(const RobotRecord& record) {
+    if ((record.kind == RobotKind::Autonomous ? autonomous.size() : remote.size()) > maxBinnedRow) return Handle{};
+    std::uint32_t block = internParams(record.detectionRadius, record.avoidanceAngle, record.speed);
+    Handle handle;
+    if (record.kind == RobotKind::Autonomous) {
+        handle = slots.insert(static_cast<std::uint8_t>(RobotKind::Autonomous), static_cast<std::uint32_t>(autonomous.size()));
+        autonomous.add(Identity{handle}, record.position, record.heading, Params{block}, SenseSchedule{}, Activity{});
+        parkedStale = parkedStale || isStationary(RobotKind::Autonomous, static_cast<std::uint32_t>(autonomous.size() - 1));
+    } else {
+        handle = slots.insert(static_cast<std::uint8_t>(RobotKind::Remote), static_cast<std::uint32_t>(remote.size()));
+        remote.add(Identity{handle}, record.position, record.heading, Params{block}, SenseSchedule{}, Activity{},
+                   record.control);
+    }
+    schedulesStale = true;
+    awakeStale = true;
+    return handle;
+}
+
+/**
+ * @brief Put the robot at the position with the orientation in degrees, e.g. to perturb the initial state
+ *
+ * @return false if the handle is stale or is not a robot
+ */
+bool World::setPose(Handle handle, double x, double y, int orientation) {
+    const SlotMap::Slot* slot = slots.find(handle);
+    if (!slot) return false;
+
+    auto place = [&](auto& table) {
+        table.template get<Position>(slot->row) = placed(x, y);
+        table.template get<Heading>(slot->row).orientation = normalizeDegrees(orientation);
+        wake(table, slot->row);
+    };
+    if (slot->table == static_cast<std::uint8_t>(RobotKind::Autonomous)) {
+        place(autonomous);
+    } else if (slot->table == static_cast<std::uint8_t>(RobotKind::Remote)) {
+        place(remote);
+    } else {
+        return false;
+    }
+    schedulesStale = true;
+    parkedStale = true;
+    return true;
+}
+
+/**
+ * @brief Remove robot of any kind in O(1)
+ *
+ * @return false if the handle is stale or is not a robot
+ */
+bool World::removeRobot(Handle handle) {
+    const SlotMap::Slot* slot = slots.find(handle);
+    if (!slot) return false;
+
+    auto removeFrom = [&](auto& table) {
+        if (table.template get<Activity>(slot->row).asleep) {
+            --sleepingRobots;
+        }
+        removeRow(table, slot->row);
+        awakeStale = true;  // the last row moved
+        parkedStale = parkedStale || parkedBins.isValid();
+    };
+    if (slot->table == static_cast<std::uint8_t>(RobotKind::Autonomous)) {
+        removeFrom(autonomous);
+    } else if (slot->table == static_cast<std::uint8_t>(RobotKind::Remote)) {
+        removeFrom(remote);
+    } else {
+        return false;
+    }
+    slots.erase(handle);
+    return true;
+}
+
+/**
+ * @brief Swap-remove the row and point the slot of the moved entity to its new row
+ */
+template <typename Table>
+void World::removeRow(Table& table, std::uint32_t row) {
+    table.remove(row);
+    if (row < table.size()) {
+        slots.relocate(table.template get<Identity>(row).handle, row);
+    }
+}
+
+/**
+ * @brief Delete every object of the world, all handles become invalid
+ */
+void World::clear() {
+    autonomous.clear();
+    remote.clear();
+    obstacles.clear();
+    obstaclesDirty = true;
+    obstacleHashSum = 0;
+    obstacleContentSum = 0;
+    paramBlocks.clear();
+    paramIndex.clear();
+    templates.clear();
+    sources.clear();
+    sinks.clear();
+    spawnedLastTick.clear();
+    despawnedLastTick.clear();
+    slots.clear();
+    alarms.clear();
+    halo.clear();
+    wokenRows[0].clear();
+    wokenRows[1].clear();
+    sleepingRobots = 0;
+    awakeStale = true;
+    parkedStale = true;
+}
+
+/**
+ * @brief Add source of autonomous robots, the first robot is spawned on the next tick
+ */
+void World::addSource(const Source& source) {
+    sources.push_back(source);
+    sources.back().countdown = 0;
+    sources.back().spawned = 0;
+}
+
+/**
+ * @brief Add square sink centered at the given point
+ */
+void World::addSink(double x, double y, double width) {
+    sinks.push_back(Sink{Box{x - width / 2, y - width / 2, x + width / 2, y + width / 2}});
+}
+
+/**
+ * @brief Advance the simulation by one tick
+ * @details only awake robots are moved, sensed and binned, sleeping robots are
+ * kept in the parked bins until they wake up
+ */
+void World::step() {
+    spawnedLastTick.clear();
+    despawnedLastTick.clear();
+    if (schedulesStale) {
+        resetSenseSchedules();
+    }
+
+    mark(Phase::ObstacleGrid, true);
+    updateObstacleGrid();
+    mark(Phase::ObstacleGrid, false);
+    mark(Phase::Sort, true);
+    sortRobots();
+    mark(Phase::Sort, false);
+    mark(Phase::Bin, true);
+    updateActivity();
+    binRobots();
+    mark(Phase::Bin, false);
+    mark(Phase::Autonomous, true);
+    if (fixedMode) {
+        runBehavior<FixedAutonomousBehavior>(autonomous, awakeRows[0], senseInterval(RobotKind::Autonomous));
+    } else {
+        runBehavior<AutonomousBehavior>(autonomous, awakeRows[0], senseInterval(RobotKind::Autonomous));
+    }
+    mark(Phase::Autonomous, false);
+    mark(Phase::Remote, true);
+    if (fixedMode) {
+        runBehavior<FixedRemoteBehavior>(remote, awakeRows[1], senseInterval(RobotKind::Remote));
+    } else {
+        runBehavior<RemoteBehavior>(remote, awakeRows[1], senseInterval(RobotKind::Remote));
+    }
+    mark(Phase::Remote, false);
+    mark(Phase::Sources, true);
+    runSources();  // while the bins are valid
+    mark(Phase::Sources, false);
+    robotBins.invalidate();
+    mark(Phase::Sinks, true);
+    runSinks();
+    mark(Phase::Sinks, false);
+    frameArena.reset();
+    ++elapsedTicks;
+}
+
+/**
+ * @brief Spawn robots from the sources whose interval elapsed
+ * @details a source waits while its spawn area is occupied
+ */
+void World::runSources() {
+    for (Source& source : sources) {
+        if (source.limit > 0 && source.spawned >= source.limit) continue;
+        if (source.countdown > 0) {
+            --source.countdown;
+            continue;
+        }
+        if (!isAreaFree(robotBox(source.x, source.y))) continue;
+
+        Handle handle = addAutonomousRobot(source.x, source.y, source.orient, source.detectionRadius,
+                                           source.avoidanceAngle, source.speed);
+        if (handle.isNull()) continue;  // no room in the table, wait as for an occupied area
+        spawnedLastTick.push_back(handle);
+        ++source.spawned;
+        ++totalSpawned;
+        source.countdown = source.interval > 0 ? source.interval - 1 : 0;
+    }
+}
+
+/**
+ * @brief Remove autonomous robots which arrived to a sink
+ * @details sleeping robots do not move, they were checked on the tick they fell asleep
+ */
+void World::runSinks() {
+    if (sinks.empty()) return;
+
+    Handle* arrived = frameArena.allocate<Handle>(autonomous.size());
+    std::size_t count = 0;
+    const auto& positions = autonomous.column<Position>();
+    auto check = [&](std::uint32_t row) {
+        for (const Sink& sink : sinks) {
+            if (boxContains(sink.box, positions[row].x, positions[row].y)) {
+                arrived[count++] = autonomous.get<Identity>(row).handle;
+                break;
+            }
+        }
+    };
+    for (std::uint32_t row : awakeRows[static_cast<int>(RobotKind::Autonomous)]) {
+        check(row);
+    }
+    for (std::uint32_t row = static_cast<std::uint32_t>(binnedAutonomous); row < autonomous.size(); ++row) {
+        check(row);  // spawned during this tick
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        removeRobot(arrived[i]);
+        despawnedLastTick.push_back(arrived[i]);
+    }
+    totalDespawned += count;
+}
+
+/**
+ * @brief Bin awake robots which can move by their position at the start of the tick
+ * @details the bins live in the frame arena, so rebuilding them every tick does not touch the heap,
+ * only chunks holding such robots are binned
+ */
+void World::binRobots() {
+    const std::vector<std::uint32_t>& awakeAutonomous = awakeRows[static_cast<int>(RobotKind::Autonomous)];
+    const std::vector<std::uint32_t>& awakeRemote = awakeRows[static_cast<int>(RobotKind::Remote)];
+    int maxSpeed = 0;
+    robotBins.begin(sceneBounds, awakeAutonomous.size() + awakeRemote.size() + halo.size(), frameArena);
+    // autonomous robots with speed 0 are in the parked bins
+    std::uint32_t* moving = frameArena.allocate<std::uint32_t>(awakeAutonomous.size());
+    std::size_t movingCount = 0;
+    for (std::uint32_t row : awakeAutonomous) {
+        int speed = paramBlocks[autonomous.get<Params>(row).block].speed;
+        if (speed == 0) continue;
+        moving[movingCount++] = row;
+        robotBins.tally(autonomous.get<Position>(row).x, autonomous.get<Position>(row).y);
+        maxSpeed = std::max(maxSpeed, std::abs(speed));
+    }
+    for (std::uint32_t row : awakeRemote) {
+        robotBins.tally(remote.get<Position>(row).x, remote.get<Position>(row).y);
+        maxSpeed = std::max(maxSpeed, std::abs(paramBlocks[remote.get<Params>(row).block].speed));
+    }
+    double haloStep = 0;
+    for (const HaloRobot& foreign : halo) {
+        robotBins.tally(foreign.position.x, foreign.position.y);
+        haloStep = std::max(haloStep, double(foreign.reach));
+    }
+    robotBins.prepare(frameArena);
+    for (std::size_t i = 0; i < movingCount; ++i) {
+        robotBins.count(autonomous.get<Position>(moving[i]).x, autonomous.get<Position>(moving[i]).y);
+    }
+    for (std::uint32_t row : awakeRemote) {
+        robotBins.count(remote.get<Position>(row).x, remote.get<Position>(row).y);
+    }
+    for (const HaloRobot& foreign : halo) {
+        robotBins.count(foreign.position.x, foreign.position.y);
+    }
+    robotBins.prefixSum();
+    for (std::size_t i = 0; i < movingCount; ++i) {
+        const Position& position = autonomous.get<Position>(moving[i]);
+        robotBins.place(position.x, position.y, static_cast<std::uint8_t>(RobotKind::Autonomous), moving[i]);
+    }
+    for (std::uint32_t row : awakeRemote) {
+        const Position& position = remote.get<Position>(row);
+        robotBins.place(position.x, position.y, static_cast<std::uint8_t>(RobotKind::Remote), row);
+    }
+    for (std::uint32_t row = 0; row < halo.size(); ++row) {
+        robotBins.place(halo[row].position.x, halo[row].position.y, haloTable, row);
+    }
+    if (synchronousMode) {
+        auto snapshot = [&](const auto& table) {
+            Position* copy = frameArena.allocate<Position>(table.size());
+            std::copy(table.template column<Position>().begin(), table.template column<Position>().end(), copy);
+            return copy;
+        };
+        snapshots[static_cast<int>(RobotKind::Autonomous)] = snapshot(autonomous);
+        snapshots[static_cast<int>(RobotKind::Remote)] = snapshot(remote);
+    }
+    robotBins.finish();
+    measuredRowGap = robotBins.meanRowGap();
+    activeChunks = robotBins.activeChunks();
+    binnedAutonomous = autonomous.size();
+    robotStep = std::max(0.1 * maxSpeed, haloStep);  // interpolated motion moves at most 10% of the speed
+    travelMargin = robotStep + 1;
+}
+
+/**
+ * @brief Run one tick of the behavior over every robot of the table
+ * @details move, sense and react to detected obstacles, policies are resolved at compile time.
+ * With an interval above 1 a robot due to sense checks the area its field of vision sweeps
+ * until its next check first and skips the checks in between if it is free, see setSenseInterval()
+ *
+ * @param interval ticks between two checks of the field of vision
+ */
+template <typename RobotBehavior, typename Table>
+void World::runBehavior(Table& table, const std::vector<std::uint32_t>& rows, int interval) {
+    for (std::uint32_t i : rows) {
+        if (!RobotBehavior::Move::move(*this, table, i)) {
+            if (RobotBehavior::Move::isParked(*this, table, i)) {
+                sleep(table, i);  // until a command
+            }
+            continue;
+        }
+        SenseSchedule& schedule = table.template get<SenseSchedule>(i);
+        if (schedule.idleTicks > 0) {
+            --schedule.idleTicks;
+            continue;
+        }
+        // a robot standing still senses now and sleeps for as long as its field of vision stays free
+        bool parked = RobotBehavior::Move::isParked(*this, table, i);
+        int coarse = parked ? 0 : coarseWindow<RobotBehavior>(table, i);
+        int window = 1;
+        if (coarse > 0) {
+            // outside the focus the robot checks now and skips the ticks until its next turn without looking ahead
+            schedule.idleTicks = static_cast<std::uint16_t>(coarse - 1);
+        } else if (!parked && kineticMode) {
+            for (int ticks = 2; ticks <= maxKineticHorizon && isSweepFree<RobotBehavior>(table, i, ticks); ticks *= 2) {
+                window = ticks;
+            }
+        } else if (!parked && interval > 1) {
+            // checks of the robots are spread over the ticks of the interval by their slot index
+            int ticks = interval - static_cast<int>((elapsedTicks + table.template get<Identity>(i).handle.index) % interval);
+            if (ticks > 1 && isSweepFree<RobotBehavior>(table, i, ticks)) {
+                window = ticks;
+            }
+        }
+        if (window > 1) {
+            schedule.idleTicks = static_cast<std::uint16_t>(window - 1);
+            continue;
+        }
+        ++sensorChecks;
+        if (RobotBehavior::Sense::sense(*this, table, i) && !missesDetection(table.template get<Identity>(i).handle)) {
+            RobotBehavior::React::react(*this, table, i);
+        } else if (parked) {
+            park<RobotBehavior>(table, i);
+        }
+    }
+}
+
+/**
+ * @brief Sensor noise: the robot overlooks what it detected in this tick, see setSensorNoise()
+ * @details decided by a hash of the seed, the robot and the tick, so a run is reproducible
+ * from its seed and does not depend on the order of the robots
+ */
+bool World::missesDetection(Handle handle) const {
+    if (missThreshold == 0) return false;
+    return mix(noiseSeed ^ mix(handle.key() + elapsedTicks * 0x9e3779b97f4a7c15ULL)) < missThreshold;
+}
+
+/**
+ * @brief Ticks from the check of an autonomous robot outside the focus to its next one, see setFarSenseInterval()
+ * @details the checks are spread over the interval by the slot index as with setSenseInterval()
+ *
+ * @return 0 if the robot is simulated in full detail
+ */
+template <typename RobotBehavior, typename Table>
+int World::coarseWindow(const Table& table, std::uint32_t row) const {
+    if (farInterval <= 1 || !std::is_same<Table, AutonomousTable>::value) {
+        return 0;
+    }
+    const Position& position = table.template get<Position>(row);
+    Handle handle = table.template get<Identity>(row).handle;
+    if (handle == focusRobot || boxContains(focusArea, position.x, position.y)) {
+        return 0;
+    }
+    const ParamBlock& block = params(table.template get<Params>(row).block);
+    double step = std::fabs(RobotBehavior::Move::stepLength(block));
+    int interval = farInterval;
+    if (step > 0) {
+        // at most half of the detection radius is driven between two checks
+        interval = std::clamp(static_cast<int>(0.5 * block.detectionRadius / step) + 1, 1, farInterval);
+    }
+    return interval - static_cast<int>((elapsedTicks + handle.index) % interval);
+}
+
+/**
+ * @brief Put a robot standing still whose field of vision is free to sleep while nothing can enter it
+ * @details the robot sleeps for good while no robot moves, otherwise a wake alarm is set
+ * to the end of the longest free time found as in setKineticScheduling(), the robot stays
+ * awake if its field of vision may be blocked on the next tick
+ */
+template <typename RobotBehavior, typename Table>
+void World::park(Table& table, std::uint32_t row) {
+    if (robotStep == 0) {
+        sleep(table, row);  // until a command
+        return;
+    }
+    int window = 1;
+    for (int ticks = 2; ticks <= maxKineticHorizon && isSweepFree<RobotBehavior>(table, row, ticks); ticks *= 2) {
+        window = ticks;
+    }
+    if (window == 1) return;
+    sleep(table, row);
+    alarms.push_back(WakeAlarm{elapsedTicks + window, table.template get<Identity>(row).handle});
+    std::push_heap(alarms.begin(), alarms.end(), std::greater<WakeAlarm>());
+}
+
+/**
+ * @brief Check if nothing can enter the field of vision of the robot during the next ticks
+ * @details the robot drives straight ahead meanwhile, see setSenseInterval()
+ */
+template <typename RobotBehavior, typename Table>
+bool World::isSweepFree(const Table& table, std::size_t row, int ticks) {
+    double length = (ticks - 1) * RobotBehavior::Move::stepLength(params(table.template get<Params>(row).block));
+    if (length < 0) {
+        return false;  // driving backwards, the sweep does not cover it
+    }
+    ++sensorChecks;
+    double margin = sweepSlack + ticks * roundingPerTick();
+    return !RobotBehavior::Sense::senseAhead(*this, table, row, length, margin, ticks);
+}
+
+/**
+ * @brief Check if the field of vision hits anything
+ * @details walls, obstacles and bodies of the other robots are checked
+ *
+ * @param self handle of the robot looking, its own body is ignored
+ * @param view field of vision in scene coordinates
+ * @param ticksAhead the other robots are grown by how far they can move in this many ticks
+ * @return true when an obstacle is detected
+ */
+bool World::isBlocked(Handle self, const Vec2 view[4], int ticksAhead) const {
+    return isViewBlocked(self, boundsOf(view), ticksAhead, [&](const Box& box) { return quadIntersectsBox(view, box); });
+}
+
+/**
+ * @brief Check if the field of vision in fixed point units hits anything, see isBlocked()
+ */
+bool World::isBlocked(Handle self, const FixedVec view[4], int ticksAhead) const {
+    return isViewBlocked(self, fromFixed(fixedBoundsOf(view)), ticksAhead, [&](const Box& box) {
+        return fixedQuadIntersectsBox(view, toFixed(box));
+    });
+}
+
+/**
+ * @brief Check walls and find obstacles and robots near the field of vision
+ *
+ * @param viewBox bounds of the field of vision
+ * @param hit hit(box) tests the field of vision against the box of a candidate
+ */
+template <typename F>
+bool World::isViewBlocked(Handle self, const Box& viewBox, int ticksAhead, F hit) const {
+    if (!boxContains(sceneBounds, viewBox)) {
+        return true;  // out of scene bounds
+    }
+
+    if (anyObstacle(viewBox, hit)) {
+        return true;
+    }
+
+    // bodies of the other robots grow by the distance they can travel in ticksAhead ticks
+    double bodyRadius = robotRadius + ticksAhead * (robotStep + roundingPerTick());
+    auto bodyBox = [&](const Position& other) {
+        return Box{other.x - bodyRadius, other.y - bodyRadius, other.x + bodyRadius, other.y + bodyRadius};
+    };
+    if (robotBins.isValid()) {
+        double reach = bodyRadius + travelMargin;
+        Box searchBox{viewBox.minX - reach, viewBox.minY - reach, viewBox.maxX + reach, viewBox.maxY + reach};
+        return robotBins.query(searchBox, [&](std::uint8_t table, std::uint32_t row) {
+            if (table == haloTable) {
+                return hit(bodyBox(halo[row].position));
+            }
+            const Identity& identity = table == static_cast<std::uint8_t>(RobotKind::Autonomous)
+                ? autonomous.get<Identity>(row) : remote.get<Identity>(row);
+            return identity.handle != self && hit(bodyBox(binnedPosition(table, row)));
+        }) || (parkedBins.isValid() && parkedBins.query(parkedSearchBox(viewBox), [&](std::uint8_t table, std::uint32_t row) {
+            const Identity& identity = table == static_cast<std::uint8_t>(RobotKind::Autonomous)
+                ? autonomous.get<Identity>(row) : remote.get<Identity>(row);
+            const Position& other = table == static_cast<std::uint8_t>(RobotKind::Autonomous)
+                ? autonomous.get<Position>(row) : remote.get<Position>(row);
+            return identity.handle != self && hit(robotBox(other.x, other.y));  // parked robots do not move
+        }));
+    }
+
+    // outside of the tick, e.g. operator commands
+    bool detected = false;
+    forEachRobot([&](RobotKind, Handle handle, const Position& other, const Heading&, const ParamBlock&) {
+        if (!detected && handle != self && hit(bodyBox(other))) {
+            detected = true;
+        }
+    });
+    return detected;
+}
+
+/**
+ * @brief Position of a binned robot as the other robots see it during the tick
+ * @details the position at the start of the tick with synchronous sensing, the current one otherwise
+ */
+const Position& World::binnedPosition(std::uint8_t table, std::uint32_t row) const {
+    if (table == haloTable) {
+        return halo[row].position;
+    }
+    if (synchronousMode) {
+        return snapshots[table][row];
+    }
+    return table == static_cast<std::uint8_t>(RobotKind::Autonomous)
+        ? autonomous.get<Position>(row) : remote.get<Position>(row);
+}
+
+/**
+ * @brief How far a binned robot can move during the tick
+ */
+double World::binnedReach(std::uint8_t table, std::uint32_t row) const {
+    if (table == haloTable) {
+        return halo[row].reach;
+    }
+    std::uint32_t block = table == static_cast<std::uint8_t>(RobotKind::Autonomous)
+        ? autonomous.get<Params>(row).block : remote.get<Params>(row).block;
+    return std::fabs(InterpolatedMotion::stepLength(paramBlocks[block])) + roundingPerTick();
+}
+
+/**
+ * @brief Check if a robot body can be placed to the area
+ *
+ * @return false if the area leaves the scene or overlaps an obstacle or a robot
+ */
+bool World::isAreaFree(const Box& area) const {
+    if (!boxContains(sceneBounds, area)) {
+        return false;
+    }
+    bool hitObstacle = anyObstacle(area, [&](const Box& box) {
+        return boxesIntersect(area, box);
+    });
+    if (hitObstacle) {
+        return false;
+    }
+
+    auto overlaps = [&](const Position& other) {
+        return boxesIntersect(area, robotBox(other.x, other.y));
+    };
+    if (robotBins.isValid()) {
+        double reach = robotRadius + travelMargin;
+        Box searchBox{area.minX - reach, area.minY - reach, area.maxX + reach, area.maxY + reach};
+        bool hitRobot = robotBins.query(searchBox, [&](std::uint8_t table, std::uint32_t row) {
+            if (!synchronousMode && table != haloTable) {
+                return overlaps(table == static_cast<std::uint8_t>(RobotKind::Autonomous)
+                                ? autonomous.get<Position>(row) : remote.get<Position>(row));
+            }
+            // anywhere the robot may have moved during the tick, the same in every region
+            const Position& other = binnedPosition(table, row);
+            double bodyRadius = robotRadius + binnedReach(table, row);
+            return boxesIntersect(area, Box{other.x - bodyRadius, other.y - bodyRadius, other.x + bodyRadius, other.y + bodyRadius});
+        });
+        hitRobot = hitRobot || (parkedBins.isValid() && parkedBins.query(parkedSearchBox(area), [&](std::uint8_t table, std::uint32_t row) {
+            return overlaps(table == static_cast<std::uint8_t>(RobotKind::Autonomous)
+                            ? autonomous.get<Position>(row) : remote.get<Position>(row));
+        }));
+        // robots added during this tick are not binned yet
+        for (std::size_t row = binnedAutonomous; row < autonomous.size() && !hitRobot; ++row) {
+            hitRobot = overlaps(autonomous.get<Position>(row));
+        }
+        return !hitRobot;
+    }
+
+    bool hitRobot = false;
+    forEachRobot([&](RobotKind, Handle, const Position& other, const Heading&, const ParamBlock&) {
+        hitRobot = hitRobot || overlaps(other);
+    });
+    return !hitRobot;
+}
+
+/**
+ * @brief Resolve handle of a remote robot
+ *
+ * @return slot of the robot or nullptr if the handle is stale or is not a remote robot
+ */
+const SlotMap::Slot* World::findRemote(Handle handle) const {
+    const SlotMap::Slot* slot = slots.find(handle);
+    if (!slot || slot->table != static_cast<std::uint8_t>(RobotKind::Remote)) return nullptr;
+    return slot;
+}
+
+/**
+ * @brief move remote controlled robot forward by its full speed
+ * If obstacle is detected, the robot stops
+ */
+void World::moveForward(Handle handle) {
+    const SlotMap::Slot* slot = findRemote(handle);
+    if (!slot) return;
+    std::size_t row = slot->row;
+
+    wake(remote, static_cast<std::uint32_t>(row));
+    RemoteControl& control = remote.get<RemoteControl>(row);
+    bool blocked = fixedMode ? FixedFieldOfViewSensor::sense(*this, remote, row)
+                             : FieldOfViewSensor::sense(*this, remote, row);
+    if (blocked) {
+        control.isMoving = false;
+        return;
+    }
+
+    Position& position = remote.get<Position>(row);
+    int orientation = remote.get<Heading>(row).orientation;
+    int speed = paramBlocks[remote.get<Params>(row).block].speed;
+    if (fixedMode) {
+        fixedAdvance(position, orientation, speed, 1);
+    } else {
+        UnitVector direction = unitVector(orientation);
+        position.x = float(position.x + speed * double(direction.x));
+        position.y = float(position.y + speed * double(direction.y));
+    }
+
+    control.isMoving = true;
+    control.rotationDirection = NoRotation;
+    schedulesStale = true;  // the robot jumped by its full speed
+}
+
+/**
+ * @brief stop the robot and keep rotating it to the right every tick
+ */
+void World::rotateRight(Handle handle) {
+    const SlotMap::Slot* slot = findRemote(handle);
+    if (!slot) return;
+    wake(remote, slot->row);
+    remote.get<RemoteControl>(slot->row) = RemoteControl{false, RotateRight};
+    std::uint16_t& orientation = remote.get<Heading>(slot->row).orientation;
+    orientation = normalizeDegrees(orientation + 1);
+}
+
+/**
+ * @brief stop the robot and keep rotating it to the left every tick
+ */
+void World::rotateLeft(Handle handle) {
+    const SlotMap::Slot* slot = findRemote(handle);
+    if (!slot) return;
+    wake(remote, slot->row);
+    remote.get<RemoteControl>(slot->row) = RemoteControl{false, RotateLeft};
+    std::uint16_t& orientation = remote.get<Heading>(slot->row).orientation;
+    orientation = normalizeDegrees(orientation - 1);
+}
+
+/**
+ * @brief stop the robot
+ */
+void World::stop(Handle handle) {
+    const SlotMap::Slot* slot = findRemote(handle);
+    if (!slot) return;
+    remote.get<RemoteControl>(slot->row) = RemoteControl{};
+}
+
+/**
+ * @brief Memory used by the engine
+ */
+MemoryFootprint World::footprint() const {
+    MemoryFootprint result{};
+    result.autonomousRow = AutonomousTable::rowBytes + sizeof(SlotMap::Slot);
+    result.remoteRow = RemoteTable::rowBytes + sizeof(SlotMap::Slot);
+    result.obstacleRow = ObstacleTable::rowBytes + sizeof(SlotMap::Slot);
+    result.robotTables = autonomous.allocatedBytes() + remote.allocatedBytes();
+    result.obstacles = obstacles.allocatedBytes();
+    result.slotMap = slots.allocatedBytes();
+    if (obstacleIndex) {  // counted in full by every world sharing it
+        result.obstacleGrid = obstacleIndex->grid.allocatedBytes() + obstacleIndex->boxes.capacity() * sizeof(Box);
+    }
+    // a map node holds the key, the value and about four pointers of bookkeeping
+    result.paramBlocks = paramBlocks.capacity() * sizeof(ParamBlock)
+        + paramIndex.size() * (sizeof(decltype(paramIndex)::value_type) + 4 * sizeof(void*))
+        + templates.size() * (sizeof(decltype(templates)::value_type) + 4 * sizeof(void*));
+    result.frameArena = frameArena.capacity();
+    return result;
+}
+
+/**
+ * @brief State of the entity at the given index
+ * @details entities are indexed as autonomous robots, then remote robots, then obstacles
+ *
+ * @param index index in [0, entityCount())
+ * @param hashHandle false to leave the handle and the parameter block index out of the hash,
+ * so the same entity hashes the same in another world, see contentHash()
+ */
+EntityState World::entityState(std::size_t index, bool hashHandle) const {
+    EntityState state{};
+    auto paramsOf = [&](std::uint32_t block) {
+        if (hashHandle) return std::uint64_t(block);
+        const ParamBlock& params = paramBlocks[block];
+        return mix(floatBits(params.detectionRadius) << 32 | floatBits(params.avoidanceAngle)) ^ std::uint32_t(params.speed);
+    };
+    if (index < autonomous.size()) {
+        const Position& position = autonomous.get<Position>(index);
+        state = EntityState{autonomous.get<Identity>(index).handle, static_cast<std::uint8_t>(RobotKind::Autonomous),
+                            position.x, position.y, autonomous.get<Heading>(index).orientation, 0};
+        state.hash = entityHash(hashHandle ? state.handle : Handle{}, state.x, state.y,
+                                std::uint64_t(state.orientation) << 32 ^ paramsOf(autonomous.get<Params>(index).block));
+        return state;
+    }
+    index -= autonomous.size();
+    if (index < remote.size()) {
+        const Position& position = remote.get<Position>(index);
+        const RemoteControl& control = remote.get<RemoteControl>(index);
+        state = EntityState{remote.get<Identity>(index).handle, static_cast<std::uint8_t>(RobotKind::Remote),
+                            position.x, position.y, remote.get<Heading>(index).orientation, 0};
+        std::uint64_t rest = std::uint64_t(state.orientation) << 32
+                             | std::uint64_t(control.isMoving) << 8 | control.rotationDirection;
+        state.hash = entityHash(hashHandle ? state.handle : Handle{}, state.x, state.y,
+                                hashHandle ? rest : rest ^ paramsOf(remote.get<Params>(index).block) << 16);
+        return state;
+    }
+    index -= remote.size();
+    const ObstacleShape& shape = obstacles.get<ObstacleShape>(index);
+    state = EntityState{obstacles.get<Identity>(index).handle, obstacleTable, shape.x, shape.y, 0, 0};
+    state.hash = obstacleHash(hashHandle ? state.handle : Handle{}, shape);
+    return state;
+}
+
+/**
+ * @brief Hash of the simulation state
+ * @details the entity hashes are summed, so the result does not depend on the order of the
+ * rows, the sum can be split between the threads of the pool and entities can be added and
+ * removed from it. Obstacles do not move, their sum is kept up to date as they are added and
+ * removed; nearly every awake robot moves every tick, keeping their sum would cost a hash per
+ * move on every tick, so the robots are hashed again when asked, which is cheaper when the
+ * hash is taken every few ticks only
+ *
+ * @param pool threads to use, nullptr to compute it on the calling thread
+ */
+std::uint64_t World::stateHash(WorkerPool* pool) const {
+    std::size_t robots = autonomous.size() + remote.size();  // entities are indexed robots first
+    if (!pool) {
+        std::uint64_t hash = obstacleHashSum;
+        for (std::size_t i = 0; i < robots; ++i) {
+            hash += entityState(i).hash;
+        }
+        return hash;
+    }
+
+    std::vector<std::uint64_t> partial(pool->size(), 0);
+    pool->parallelFor(robots, [&](std::size_t begin, std::size_t end, unsigned chunk) {
+        std::uint64_t sum = 0;
+        for (std::size_t i = begin; i < end; ++i) {
+            sum += entityState(i).hash;
+        }
+        partial[chunk] = sum;
+    });
+    std::uint64_t hash = obstacleHashSum;
+    for (std::uint64_t sum : partial) {
+        hash += sum;
+    }
+    return hash;
+}
+
+/**
+ * @brief Hash of the simulation state without the handles
+ * @details equal for worlds holding the same entities in any order and under any handles,
+ * e.g. a world split into regions simulated separately and the whole one
+ */
+std::uint64_t World::contentHash() const {
+    std::uint64_t hash = obstacleContentSum;
+    for (std::size_t i = 0; i < autonomous.size() + remote.size(); ++i) {
+        hash += entityState(i, false).hash;
+    }
+    return hash;
+}
+
+static constexpr std::uint32_t imageMagic = 0x31494d53;  // "SMI1", bumped when the image layout changes
+
+template <typename T>
+static void putValue(std::vector<char>& image, const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "only plain data is copied byte by byte");
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    image.insert(image.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static void putVector(std::vector<char>& image, const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable<T>::value, "only plain data is copied byte by byte");
+    putValue(image, static_cast<std::uint64_t>(values.size()));
+    const char* bytes = reinterpret_cast<const char*>(values.data());
+    image.insert(image.end(), bytes, bytes + values.size() * sizeof(T));
+}
+
+template <typename... Components>
+static void putTable(std::vector<char>& image, const Archetype<Components...>& table) {
+    (putVector(image, table.template column<Components>()), ...);
+}
+
+/**
+ * @brief Reads the values written by putValue() and putVector() back, fails instead of reading past the end
+ */
+struct ImageReader {
+    const std::vector<char>& image;
+    std::size_t offset = 0;
+
+    template <typename T>
+    bool value(T& value) {
+        if (image.size() - offset < sizeof(T)) return false;
+        std::memcpy(&value, image.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool vector(std::vector<T>& values) {
+        std::uint64_t count;
+        if (!value(count) || count > (image.size() - offset) / sizeof(T)) return false;
+        values.resize(static_cast<std::size_t>(count));
+        std::memcpy(values.data(), image.data() + offset, values.size() * sizeof(T));
+        offset += values.size() * sizeof(T);
+        return true;
+    }
+
+    template <typename... Components>
+    bool table(Archetype<Components...>& table) {
+        if (!(vector(table.template column<Components>()) && ...)) return false;
+        std::size_t rows = table.size();
+        return ((table.template column<Components>().size() == rows) && ...);
+    }
+};
+
+/**
+ * @brief Parameter blocks are found by their values, see internParams()
+ */
+struct ParamIndexEntry {
+    float detectionRadius;
+    float avoidanceAngle;
+    std::int32_t speed;
+    std::uint32_t block;
+};
+
+/**
+ * @brief Append the exact state of the world to the image
+ * @details the image holds the tables, the slot map, the sleeping robots, the sources and every
+ * setting and counter a tick depends on, so a world restored by readImage() in another process
+ * runs the same ticks under the same handles. The obstacle grid and the bins are not copied, the
+ * restored world builds them on its first tick; the phase hook stays with this world
+ */
+void World::writeImage(std::vector<char>& image) const {
+    // one allocation, the image of a large world takes tens of megabytes
+    image.reserve(image.size() + 4096 + autonomous.size() * AutonomousTable::rowBytes + remote.size() * RemoteTable::rowBytes
+                  + obstacles.size() * ObstacleTable::rowBytes + slots.allocatedBytes() + alarms.size() * sizeof(WakeAlarm)
+                  + paramBlocks.size() * sizeof(ParamBlock) * 2 + (sources.size() + sinks.size()) * sizeof(Source)
+                  + halo.size() * sizeof(HaloRobot) + (wokenRows[0].size() + wokenRows[1].size()) * sizeof(std::uint32_t)
+                  + (spawnedLastTick.size() + despawnedLastTick.size()) * sizeof(Handle));
+    putValue(image, imageMagic);
+    putValue(image, sceneBounds);
+    putValue(image, fixedMode);
+    putValue(image, kineticMode);
+    putValue(image, synchronousMode);
+    putValue(image, spatialSorting);
+    putValue(image, senseIntervals);
+    putValue(image, farInterval);
+    putValue(image, focusArea);
+    putValue(image, focusRobot);
+    putValue(image, missThreshold);
+    putValue(image, noiseSeed);
+    putValue(image, elapsedTicks);
+    putValue(image, sensorChecks);
+    putValue(image, totalSpawned);
+    putValue(image, totalDespawned);
+    putValue(image, totalSorts);
+    putValue(image, sortedRowGap);
+    putValue(image, measuredRowGap);
+    putValue(image, sortedLastTick);
+    putValue(image, schedulesStale);
+    putValue(image, robotStep);
+    putValue(image, travelMargin);
+    putValue(image, sleepingRobots);
+    putValue(image, obstacleHashSum);
+    putValue(image, obstacleContentSum);
+
+    putVector(image, paramBlocks);
+    std::vector<ParamIndexEntry> index;
+    for (const auto& entry : paramIndex) {
+        index.push_back(ParamIndexEntry{std::get<0>(entry.first), std::get<1>(entry.first), std::get<2>(entry.first), entry.second});
+    }
+    putVector(image, index);
+    putValue(image, static_cast<std::uint64_t>(templates.size()));
+    for (const auto& entry : templates) {
+        putVector(image, std::vector<char>(entry.first.begin(), entry.first.end()));
+        putValue(image, entry.second);
+    }
+
+    putTable(image, autonomous);
+    putTable(image, remote);
+    putTable(image, obstacles);
+    putVector(image, slots.allSlots());
+    putValue(image, slots.firstFree());
+    putVector(image, alarms);
+    putVector(image, wokenRows[0]);
+    putVector(image, wokenRows[1]);
+    putVector(image, sources);
+    putVector(image, sinks);
+    putVector(image, halo);
+    putVector(image, spawnedLastTick);
+    putVector(image, despawnedLastTick);
+}
+
+/**
+ * @brief Replace the world by the one written by writeImage()
+ *
+ * @return false if the image is damaged or of another version, the world is empty then
+ */
+bool World::readImage(const std::vector<char>& image) {
+    clear();
+    ImageReader in{image};
+    std::uint32_t magic = 0;
+    std::uint64_t templateCount = 0;
+    std::vector<ParamIndexEntry> index;
+    bool ok = in.value(magic) && magic == imageMagic
+        && in.value(sceneBounds) && in.value(fixedMode) && in.value(kineticMode) && in.value(synchronousMode)
+        && in.value(spatialSorting) && in.value(senseIntervals) && in.value(farInterval) && in.value(focusArea)
+        && in.value(focusRobot) && in.value(missThreshold) && in.value(noiseSeed) && in.value(elapsedTicks)
+        && in.value(sensorChecks) && in.value(totalSpawned) && in.value(totalDespawned) && in.value(totalSorts)
+        && in.value(sortedRowGap) && in.value(measuredRowGap) && in.value(sortedLastTick) && in.value(schedulesStale)
+        && in.value(robotStep) && in.value(travelMargin) && in.value(sleepingRobots)
+        && in.value(obstacleHashSum) && in.value(obstacleContentSum)
+        && in.vector(paramBlocks) && in.vector(index) && in.value(templateCount);
+    for (std::uint64_t i = 0; ok && i < templateCount; ++i) {
+        std::vector<char> name;
+        std::uint32_t block = 0;
+        ok = in.vector(name) && in.value(block) && block < paramBlocks.size();
+        if (ok) templates[std::string(name.begin(), name.end())] = block;
+    }
+    for (const ParamIndexEntry& entry : index) {
+        ok = ok && entry.block < paramBlocks.size();
+        paramIndex[std::make_tuple(entry.detectionRadius, entry.avoidanceAngle, entry.speed)] = entry.block;
+    }
+
+    std::vector<SlotMap::Slot> copiedSlots;
+    std::uint32_t freeHead = 0;
+    ok = ok && in.table(autonomous) && in.table(remote) && in.table(obstacles)
+        && in.vector(copiedSlots) && in.value(freeHead) && in.vector(alarms) && in.vector(wokenRows[0])
+        && in.vector(wokenRows[1]) && in.vector(sources) && in.vector(sinks) && in.vector(halo)
+        && in.vector(spawnedLastTick) && in.vector(despawnedLastTick) && in.offset == image.size();
+    for (const Params& params : autonomous.column<Params>()) {
+        ok = ok && params.block < paramBlocks.size();
+    }
+    for (const Params& params : remote.column<Params>()) {
+        ok = ok && params.block < paramBlocks.size();
+    }
+    if (!ok) {
+        clear();
+        return false;
+    }
+    slots.assign(copiedSlots, freeHead);
+    obstacleIndex.reset();
+    obstaclesDirty = true;
+    awakeStale = true;
+    parkedStale = true;
+    fellAsleep = false;
+    return true;
+}
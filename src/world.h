@@ -0,0 +1,388 @@
+/**
+ * @file world.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief File containing the simulation engine state and systems
+ */
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "archetype.h"
+#include "arena.h"
+#include "components.h"
+#include "geometry.h"
+#include "spatialgrid.h"
+
+using AutonomousTable = Archetype<Identity, Position, Heading, Params, SenseSchedule, Activity>;
+using RemoteTable = Archetype<Identity, Position, Heading, Params, SenseSchedule, Activity, RemoteControl>;
+using ObstacleTable = Archetype<Identity, ObstacleShape>;
+
+constexpr std::uint8_t obstacleTable = 2;  // slot table of obstacles, robots use their RobotKind
+constexpr std::uint8_t haloTable = 3;  // bin table of the foreign robots, see World::setHalo()
+
+/**
+ * @brief Place spawning autonomous robots every interval ticks
+ */
+struct Source {
+    double x, y;
+    int orient;  // orientation index as for AutonomousRobot
+    double detectionRadius;
+    double avoidanceAngle;
+    int speed;
+    int interval = 100;  // ticks between two spawns
+    long limit = 0;  // total number of robots to spawn, 0 for no limit
+    long spawned = 0;
+    int countdown = 0;  // ticks until the next spawn
+};
+
+/**
+ * @brief Area removing autonomous robots whose center enters it
+ */
+struct Sink {
+    Box box;
+};
+
+class WorkerPool;
+
+/**
+ * @brief Tick a parked robot has to check its field of vision again
+ */
+struct WakeAlarm {
+    std::uint64_t tick;
+    Handle handle;
+
+    bool operator>(const WakeAlarm& other) const { return tick > other.tick; }
+};
+
+/**
+ * @brief Robot simulated in another world, the robots of this world only see it
+ */
+struct HaloRobot {
+    Position position;  // at the start of the tick
+    float reach;  // how far it can move in one tick
+};
+
+/**
+ * @brief Complete state of a robot, used to move it to another world
+ */
+struct RobotRecord {
+    RobotKind kind;
+    Position position;
+    Heading heading;
+    float detectionRadius;
+    float avoidanceAngle;
+    std::int32_t speed;
+    RemoteControl control;
+};
+
+/**
+ * @brief Obstacle grid with the boxes of the obstacles it lists, immutable once built
+ * @details worlds with the same bounds and obstacles can share one, see World::shareObstacles()
+ */
+struct ObstacleIndex {
+    ChunkedObstacleGrid grid;
+    std::vector<Box> boxes;  // per row of the grid
+    std::uint64_t key;  // hash of the bounds and the obstacles it was built for
+};
+
+/**
+ * @brief Exact state of one entity as compared between runs
+ */
+struct EntityState {
+    Handle handle;
+    std::uint8_t table;  // RobotKind of robots, obstacleTable for obstacles
+    float x, y;
+    std::uint16_t orientation;
+    std::uint64_t hash;  // hash of all the state of the entity
+};
+
+/**
+ * @brief Phases of one simulation tick, reported to the phase hook
+ */
+enum class Phase : std::uint8_t {
+    ObstacleGrid,
+    Sort,
+    Bin,
+    Autonomous,
+    Remote,
+    Sources,
+    Sinks,
+    Count
+};
+
+/**
+ * @brief Called at the begin and the end of every phase of a tick, used by the benchmark
+ */
+using PhaseHook = void (*)(void* context, Phase phase, bool begin);
+
+/**
+ * @brief Memory used by the engine, see World::footprint()
+ * @details per entity values are the bytes of one table row plus its slot,
+ * the other values are bytes actually reserved, including unused capacity
+ */
+struct MemoryFootprint {
+    std::size_t autonomousRow;
+    std::size_t remoteRow;
+    std::size_t obstacleRow;
+    std::size_t robotTables;
+    std::size_t obstacles;
+    std::size_t slotMap;
+    std::size_t obstacleGrid;
+    std::size_t paramBlocks;  // shared parameter blocks and their index
+    std::size_t frameArena;
+
+    std::size_t total() const {
+        return robotTables + obstacles + slotMap + obstacleGrid + paramBlocks + frameArena;
+    }
+};
+
+/**
+ * @class World
+ * @brief Simulation engine, owns all robots and obstacles
+ * @details every robot kind is a dense archetype table, one tick of the
+ * simulation runs the behavior of each kind over its table (see behaviors.h)
+ */
+class World {
+public:
+    AutonomousTable autonomous;
+    RemoteTable remote;
+    ObstacleTable obstacles;
+    std::vector<Source> sources;
+    std::vector<Sink> sinks;
+
+    void setBounds(const Box& newBounds);
+    const Box& bounds() const { return sceneBounds; }
+    const FrameArena& arena() const { return frameArena; }
+    MemoryFootprint footprint() const;
+
+    /**
+     * @brief Parameter block referenced by the Params component
+     */
+    const ParamBlock& params(std::uint32_t block) const { return paramBlocks[block]; }
+    std::size_t paramBlockCount() const { return paramBlocks.size(); }
+    std::uint32_t addTemplate(const std::string& name, double detectionRadius, double avoidanceAngle, int speed);
+    const ParamBlock* findTemplate(const std::string& name) const;
+
+    Handle addObstacle(double x, double y, double width);
+    bool removeObstacle(Handle handle);
+    Handle addAutonomousRobot(double x, double y, int orient, double detectionRadius, double avoidanceAngle, int speed);
+    Handle addRemoteRobot(double x, double y, int speed, double detectionRadius);
+    bool removeRobot(Handle handle);
+    bool setPose(Handle handle, double x, double y, int orientation);
+    void addSource(const Source& source);
+    void addSink(double x, double y, double width);
+    std::uint64_t obstacleKey() const;
+    void prepareObstacles();
+    bool shareObstacles(World& other);
+    bool borrowObstacles(const World& other);
+    bool sharesObstacles() const { return obstacleIndex && obstacleIndex.use_count() > 1; }
+    bool contains(Handle handle) const { return slots.contains(handle); }
+    void clear();
+    void writeImage(std::vector<char>& image) const;
+    bool readImage(const std::vector<char>& image);
+
+    void step();
+
+    std::size_t entityCount() const { return autonomous.size() + remote.size() + obstacles.size(); }
+    EntityState entityState(std::size_t index, bool hashHandle = true) const;
+    std::uint64_t stateHash(WorkerPool* pool = nullptr) const;
+    std::uint64_t contentHash() const;
+    bool isBlocked(Handle self, const Vec2 view[4], int ticksAhead = 0) const;
+    bool isBlocked(Handle self, const FixedVec view[4], int ticksAhead = 0) const;
+    bool isAreaFree(const Box& area) const;
+
+    /**
+     * @brief Robots created by sources during the last tick
+     */
+    const std::vector<Handle>& spawned() const { return spawnedLastTick; }
+
+    /**
+     * @brief Robots removed by sinks during the last tick, their handles are already stale
+     */
+    const std::vector<Handle>& despawned() const { return despawnedLastTick; }
+
+    std::uint64_t spawnCount() const { return totalSpawned; }
+    std::uint64_t despawnCount() const { return totalDespawned; }
+
+    /**
+     * @brief Enable reordering of the robot tables by Z-order of their positions
+     */
+    void setSpatialSorting(bool enabled) { spatialSorting = enabled; }
+    void setFixedPoint(bool enabled);
+    bool fixedPoint() const { return fixedMode; }
+    void setPhaseHook(PhaseHook hook, void* context) { phaseHook = hook; phaseContext = context; }
+    void setSenseInterval(RobotKind kind, int interval);
+    int senseInterval(RobotKind kind) const { return senseIntervals[static_cast<int>(kind)]; }
+    void setKineticScheduling(bool enabled);
+    bool kineticScheduling() const { return kineticMode; }
+    void setSynchronousSensing(bool enabled);
+    bool synchronousSensing() const { return synchronousMode; }
+    void setHalo(const std::vector<HaloRobot>& robots);
+    std::vector<HaloRobot> haloRobots(const Box& area) const;
+    double sensingReach() const;
+    RobotRecord robotRecord(Handle handle) const;
+    Handle insertRobot(const RobotRecord& record);
+    void setSensorNoise(double missProbability, std::uint64_t seed);
+    void setFarSenseInterval(int interval);
+    int farSenseInterval() const { return farInterval; }
+
+    /**
+     * @brief Area and robot simulated in full detail when the far sensing interval is above 1
+     */
+    void setFocus(const Box& area, Handle robot = Handle{}) { focusArea = area; focusRobot = robot; }
+
+    /**
+     * @brief Number of field of vision tests run by the robots, including the tests looking ahead
+     */
+    std::uint64_t sensorCheckCount() const { return sensorChecks; }
+    std::uint64_t tickCount() const { return elapsedTicks; }
+
+    /**
+     * @brief Number of robots simulated every tick, the other robots sleep
+     */
+    std::size_t awakeCount() const { return autonomous.size() + remote.size() - sleepingRobots; }
+    bool isIdle() const;
+    std::uint64_t sortCount() const { return totalSorts; }
+
+    /**
+     * @brief Locality of the robot tables measured in the last tick, see RobotBins::meanRowGap()
+     */
+    double rowGap() const { return measuredRowGap; }
+
+    /**
+     * @brief Chunks holding moving robots in the last tick, only those are binned and searched
+     */
+    std::size_t activeChunkCount() const { return activeChunks; }
+    std::size_t chunkCount() const;
+
+    void moveForward(Handle handle);
+    void rotateRight(Handle handle);
+    void rotateLeft(Handle handle);
+    void stop(Handle handle);
+
+    /**
+     * @brief Call f(kind, handle, position, heading, params) for every robot
+     */
+    template <typename F>
+    void forEachRobot(F f) const {
+        for (std::size_t i = 0; i < autonomous.size(); ++i) {
+            f(RobotKind::Autonomous, autonomous.get<Identity>(i).handle, autonomous.get<Position>(i),
+              autonomous.get<Heading>(i), paramBlocks[autonomous.get<Params>(i).block]);
+        }
+        for (std::size_t i = 0; i < remote.size(); ++i) {
+            f(RobotKind::Remote, remote.get<Identity>(i).handle, remote.get<Position>(i),
+              remote.get<Heading>(i), paramBlocks[remote.get<Params>(i).block]);
+        }
+    }
+
+private:
+    Box sceneBounds{0, 0, 1500, 600};
+    SlotMap slots;
+    std::shared_ptr<const ObstacleIndex> obstacleIndex;  // rebuilt lazily when dirty, may be shared
+    bool obstaclesDirty = true;
+    std::uint64_t obstacleHashSum = 0;  // of the obstacle entity hashes, kept by addObstacle() and removeObstacle()
+    std::uint64_t obstacleContentSum = 0;  // the same without the handles, see contentHash()
+    std::vector<ParamBlock> paramBlocks;
+    std::map<std::tuple<float, float, std::int32_t>, std::uint32_t> paramIndex;
+    std::map<std::string, std::uint32_t> templates;  // named parameter blocks of the scene
+    ChunkedRobotBins robotBins;  // awake robots, valid only while step() runs
+    ChunkedRobotBins parkedBins;  // robots which can not move, see isStationary()
+    FrameArena parkedArena{0};  // storage of the parked bins
+    std::vector<std::uint32_t> awakeRows[2];  // rows of the awake robots per RobotKind, ascending
+    std::vector<std::uint32_t> wokenRows[2];  // rows woken up since the last tick per RobotKind
+    std::vector<std::uint32_t> mergedRows;  // scratch of refreshAwake()
+    std::vector<WakeAlarm> alarms;  // min-heap of the wake-up ticks of parked autonomous robots
+    std::size_t sleepingRobots = 0;
+    bool awakeStale = true;  // rows moved, awakeRows have to be rebuilt
+    bool fellAsleep = false;  // robots fell asleep during the last tick
+    bool parkedStale = true;
+    FrameArena frameArena;  // scratch data of the current tick
+    double robotStep = 0;  // how far a robot can move in one tick
+    double travelMargin = 0;  // the same with a slack for the bins
+    std::size_t binnedAutonomous = 0;  // autonomous rows above this were added during the tick
+    std::vector<Handle> spawnedLastTick;
+    std::vector<Handle> despawnedLastTick;
+    std::uint64_t totalSpawned = 0;
+    std::uint64_t totalDespawned = 0;
+    bool spatialSorting = true;
+    bool fixedMode = false;
+    PhaseHook phaseHook = nullptr;
+    void* phaseContext = nullptr;
+    double measuredRowGap = 0;
+    std::size_t activeChunks = 0;  // chunks binned in the last tick
+    double sortedRowGap = 0;  // row gap right after the last sort, the best the order can do
+    bool sortedLastTick = false;
+    std::uint64_t totalSorts = 0;
+    int senseIntervals[2] = {1, 1};  // per RobotKind
+    bool kineticMode = false;
+    bool synchronousMode = false;
+    std::vector<HaloRobot> halo;
+    const Position* snapshots[2] = {nullptr, nullptr};  // positions at the start of the tick per RobotKind
+    std::uint64_t missThreshold = 0;  // a detection is missed when the noise hash is below it
+    std::uint64_t noiseSeed = 0;
+    int farInterval = 1;  // sensing interval of autonomous robots outside the focus, 1 = exact
+    Box focusArea{0, 0, 0, 0};
+    Handle focusRobot;
+    bool schedulesStale = false;  // the world changed, every robot has to sense on the next tick
+    std::uint64_t elapsedTicks = 0;
+    std::uint64_t sensorChecks = 0;
+
+    std::uint32_t internParams(double detectionRadius, double avoidanceAngle, int speed);
+    void updateObstacleGrid();
+    Position placed(double x, double y) const;
+    template <typename F>
+    bool isViewBlocked(Handle self, const Box& viewBox, int ticksAhead, F hit) const;
+    template <typename F>
+    bool anyObstacle(const Box& box, F hit) const;
+    const Position& binnedPosition(std::uint8_t table, std::uint32_t row) const;
+    double binnedReach(std::uint8_t table, std::uint32_t row) const;
+    bool missesDetection(Handle handle) const;
+    void binRobots();
+    void sortRobots();
+    void mark(Phase phase, bool begin) {
+        if (phaseHook) phaseHook(phaseContext, phase, begin);
+    }
+    template <typename Component, typename Table, typename F>
+    void sortByMortonKey(Table& table, F centerOf, FrameArena& scratch);
+    void runSources();
+    void runSinks();
+    void resetSenseSchedules();
+    void updateActivity();
+    template <typename Table>
+    void collectAwake(const Table& table, std::vector<std::uint32_t>& rows);
+    template <typename Table>
+    void refreshAwake(const Table& table, std::vector<std::uint32_t>& rows, std::vector<std::uint32_t>& woken);
+    bool isStationary(RobotKind kind, std::uint32_t row) const;
+    template <typename Table>
+    void sleep(Table& table, std::uint32_t row);
+    template <typename Table>
+    void wake(Table& table, std::uint32_t row);
+    double roundingPerTick() const;
+
+    template <typename RobotBehavior, typename Table>
+    void runBehavior(Table& table, const std::vector<std::uint32_t>& rows, int interval);
+    template <typename RobotBehavior, typename Table>
+    bool isSweepFree(const Table& table, std::size_t row, int ticks);
+    template <typename RobotBehavior, typename Table>
+    void park(Table& table, std::uint32_t row);
+    template <typename RobotBehavior, typename Table>
+    int coarseWindow(const Table& table, std::uint32_t row) const;
+
+    /**
+     * @brief Area of the parked bins holding robots which may overlap the box
+     */
+    Box parkedSearchBox(const Box& box) const {
+        return Box{box.minX - robotRadius, box.minY - robotRadius, box.maxX + robotRadius, box.maxY + robotRadius};
+    }
+    template <typename Table>
+    void removeRow(Table& table, std::uint32_t row);
+    const SlotMap::Slot* findRemote(Handle handle) const;
+};
+
+#endif // WORLD_H
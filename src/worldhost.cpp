@@ -0,0 +1,129 @@
+/**
+ * @file worldhost.cpp
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Many independent worlds simulated in one process on the worker pool
+ * @details usage: simulation --host [--copies N] [--ticks T] [--threads N] scene.txt...
+ * runs N copies of every scene side by side and checks that all copies of a scene end the same
+ */
+#include "worldhost.h"
+#include "scene.h"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+/**
+ * @brief Take over the world, it shares the obstacle grid of an earlier world with the same obstacles
+ *
+ * @return index of the world
+ */
+std::size_t WorldHost::add(std::unique_ptr<World> world) {
+    std::size_t index = worlds.size();
+    auto owner = owners.find(world->obstacleKey());
+    if (owner == owners.end() || !world->shareObstacles(*worlds[owner->second])) {
+        owners[world->obstacleKey()] = index;
+    }
+    worlds.push_back(std::move(world));
+    return index;
+}
+
+/**
+ * @brief Advance every world by the given number of ticks
+ * @details the worlds are independent, so a thread runs all the ticks of a world at once
+ */
+void WorldHost::step(long ticks) {
+    forEach([&](std::size_t, World& world) {
+        for (long tick = 0; tick < ticks; ++tick) {
+            world.step();
+        }
+    });
+}
+
+/**
+ * @brief Options of the hosting run
+ */
+struct HostOptions {
+    long copies = 100;  // worlds per scene
+    long ticks = 1000;
+    unsigned threads = std::thread::hardware_concurrency();
+    std::vector<std::string> scenes;
+};
+
+/**
+ * @brief Parse command line arguments following --host
+ *
+ * @return false on invalid arguments
+ */
+static bool parseOptions(int argc, char *argv[], HostOptions& options) {
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--copies" || arg == "--ticks" || arg == "--threads") && i + 1 < argc) {
+            long value = std::strtol(argv[++i], nullptr, 10);
+            if (value <= 0) return false;
+            if (arg == "--copies") options.copies = value;
+            else if (arg == "--ticks") options.ticks = value;
+            else options.threads = static_cast<unsigned>(value);
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            options.scenes.push_back(arg);
+        }
+    }
+    return !options.scenes.empty();
+}
+
+/**
+ * @brief Entry point of the hosting run
+ *
+ * @param argc number of arguments following --host
+ * @param argv arguments following --host
+ * @return int exit code, 1 when copies of a scene ended differently
+ */
+int runHost(int argc, char *argv[]) {
+    HostOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "usage: simulation --host [--copies N] [--ticks T] [--threads N] scene.txt...\n");
+        return 2;
+    }
+
+    WorkerPool pool(options.threads);
+    WorldHost host(pool);
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& filename : options.scenes) {
+        Scene scene;
+        if (!loadScene(filename, scene)) {
+            std::fprintf(stderr, "Cannot open file for reading: %s\n", filename.c_str());
+            return 2;
+        }
+        for (long copy = 0; copy < options.copies; ++copy) {
+            auto world = std::make_unique<World>();
+            populateWorld(*world, scene);
+            host.add(std::move(world));
+        }
+    }
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%zu worlds on %u threads, %zu obstacle grids, loaded in %.3f s\n",
+                host.size(), pool.size(), host.obstacleSets(), loadSeconds);
+
+    start = std::chrono::steady_clock::now();
+    host.step(options.ticks);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<std::uint64_t> hashes(host.size());
+    host.forEach([&](std::size_t index, World& world) { hashes[index] = world.stateHash(); });
+    bool ok = true;
+    for (std::size_t scene = 0; scene < options.scenes.size(); ++scene) {
+        std::size_t first = scene * options.copies;
+        bool same = true;
+        for (long copy = 1; copy < options.copies; ++copy) {
+            same = same && hashes[first + copy] == hashes[first];
+        }
+        ok = ok && same;
+        std::printf("%s %s hash %016" PRIx64 "\n", same ? "SAME" : "DIFFER", options.scenes[scene].c_str(), hashes[first]);
+    }
+    double worldTicks = double(host.size()) * options.ticks;
+    std::printf("%.0f world ticks in %.3f s, %.1f world ticks/sec\n", worldTicks, seconds, seconds > 0 ? worldTicks / seconds : 0.0);
+    return ok ? 0 : 1;
+}
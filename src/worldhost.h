@@ -0,0 +1,58 @@
+/**
+ * @file worldhost.h
+ * @author Yaroslav Slabik (xslabi01)
+ * @author Kininbayev Timur (xkinin00)
+ * @brief Many independent worlds simulated in one process on the worker pool
+ */
+#ifndef WORLDHOST_H
+#define WORLDHOST_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "threadpool.h"
+#include "world.h"
+
+/**
+ * @class WorldHost
+ * @brief Owns independent worlds and steps them in parallel, one world on one thread at a time
+ * @details worlds with the same bounds and obstacles share one obstacle grid. Small
+ * worlds do not keep a core busy on their own, so the threads pick the next world
+ * to run when they finish one instead of splitting the worlds evenly in advance
+ */
+class WorldHost {
+public:
+    explicit WorldHost(WorkerPool& pool) : pool(pool) {}
+
+    std::size_t add(std::unique_ptr<World> world);
+    World& world(std::size_t index) { return *worlds[index]; }
+    const World& world(std::size_t index) const { return *worlds[index]; }
+    std::size_t size() const { return worlds.size(); }
+    std::size_t obstacleSets() const { return owners.size(); }  // distinct obstacle grids
+
+    void step(long ticks = 1);
+
+    /**
+     * @brief Run f(index, world) for every world on the pool, each world on one thread
+     */
+    template <typename F>
+    void forEach(F f) {
+        std::atomic<std::size_t> next{0};
+        pool.parallelFor(pool.size(), [&](std::size_t, std::size_t, unsigned) {
+            for (std::size_t index = next++; index < worlds.size(); index = next++) {
+                f(index, *worlds[index]);
+            }
+        });
+    }
+
+private:
+    WorkerPool& pool;
+    std::vector<std::unique_ptr<World>> worlds;
+    std::unordered_map<std::uint64_t, std::size_t> owners;  // obstacle key of the first world holding those obstacles
+};
+
+int runHost(int argc, char *argv[]);
+
+#endif // WORLDHOST_H